@@ -109,6 +109,15 @@ Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeGetInp
                                                                                          jobject instance,
                                                                                          jlong cubeDetectorHandle);
 
+JNIEXPORT jfloatArray JNICALL
+Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeGetStageLatencies(JNIEnv *env,
+                                                                                         jclass type);
+
+JNIEXPORT void JNICALL
+Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeFlushLogs(JNIEnv *env,
+                                                                                 jobject instance,
+                                                                                 jlong cubeDetectorHandle);
+
 #ifdef __cplusplus
 }
 #endif
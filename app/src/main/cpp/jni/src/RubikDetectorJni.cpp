@@ -2,6 +2,7 @@
 // Created by catalin on 15.07.2017.
 //
 #include <jni.h>
+#include <array>
 #include <vector>
 #include "../include/RubikDetectorJni.hpp"
 #include "../../rubikdetectorcore/include/rubikdetector/imagesaver/ImageSaver.hpp"
@@ -32,7 +33,8 @@ Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeCreate
     std::shared_ptr<rbdt::ImageSaver> imageSaver;
     if (storagePath != NULL) {
         const char *cppStoragePath = env->GetStringUTFChars(storagePath, 0);
-        imageSaver = std::make_shared<rbdt::ImageSaver>(cppStoragePath);
+        // Written in the background, so debug captures don't slow down the detection. Big enough for all the facelets of a cube
+        imageSaver = std::make_shared<rbdt::ImageSaver>(cppStoragePath, rbdt::ImageSaver::Format::JPEG, 64);
         env->ReleaseStringUTFChars(storagePath, cppStoragePath);
     } else {
         imageSaver = nullptr;
@@ -57,6 +59,7 @@ Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeReleas
     rbdt::RubikProcessor &cubeDetector = *reinterpret_cast<rbdt::RubikProcessor *>(cubeDetectorHandle);
     LOG_DEBUG("RUBIK_JNI_PART.cpp", "nativeReleaseCube");
     delete &cubeDetector;
+    LOG_FLUSH();
 }
 
 JNIEXPORT jboolean JNICALL
@@ -196,15 +199,41 @@ Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeGetInp
     return cubeDetector.getFrameYUVBufferOffset();
 }
 
+JNIEXPORT jfloatArray JNICALL
+Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeGetStageLatencies(JNIEnv *env,
+                                                                                         jclass type) {
+    std::vector<rbdt::StageLatency> latencies = rbdt::RubikProcessor::getStageLatencies();
+    // count, p50, p95 & p99 of every stage, in declaration order
+    std::vector<jfloat> flattenedLatencies;
+    flattenedLatencies.reserve(latencies.size() * 4);
+    for (const rbdt::StageLatency &latency : latencies) {
+        flattenedLatencies.push_back((jfloat) latency.count);
+        flattenedLatencies.push_back(latency.p50Millis);
+        flattenedLatencies.push_back(latency.p95Millis);
+        flattenedLatencies.push_back(latency.p99Millis);
+    }
+    jfloatArray retArray = env->NewFloatArray(flattenedLatencies.size());
+    env->SetFloatArrayRegion(retArray, 0, flattenedLatencies.size(), flattenedLatencies.data());
+    return retArray;
+}
+
+JNIEXPORT void JNICALL
+Java_com_jorkoh_rubiksscanandsolve_scan_rubikdetector_RubikDetector_nativeFlushLogs(JNIEnv *env,
+                                                                                 jobject instance,
+                                                                                 jlong cubeDetectorHandle) {
+    rbdt::RubikProcessor &cubeDetector = *reinterpret_cast<rbdt::RubikProcessor *>(cubeDetectorHandle);
+    cubeDetector.flushLogs();
+}
+
 #ifdef __cplusplus
 }
 #endif
 
 jintArray processResult(const rbdt::CubeState &result, _JNIEnv *env) {
-    if (!result.facelets.empty() && !result.colors.empty()) {
-        size_t data_size = 54 + 6*3;
-        jint flattenedResult[data_size];
-        jint *currentPos = flattenedResult;
+    if (result.valid) {
+        constexpr size_t data_size = 54 + 6 * 3;
+        std::array<jint, data_size> flattenedResult;
+        jint *currentPos = flattenedResult.data();
         // facelets face
         for (int i = 0; i < 54; i++) {
             *(currentPos++) = rbdt::asInt(result.facelets[i]);
@@ -217,7 +246,7 @@ jintArray processResult(const rbdt::CubeState &result, _JNIEnv *env) {
         }
 
         jintArray retArray = env->NewIntArray(data_size);
-        env->SetIntArrayRegion(retArray, 0, data_size, (jint *) flattenedResult);
+        env->SetIntArrayRegion(retArray, 0, data_size, flattenedResult.data());
         return retArray;
     } else {
         return NULL;
@@ -8,7 +8,7 @@
 namespace rbdt {
 
 /**
- * Simple data class representing a 2D Point.
+ * Simple data class representing a 2D Point. Trivially copyable.
  */
 class Point2d {
 public:
@@ -16,8 +16,6 @@ public:
 
     Point2d(const float x, const float y);
 
-    ~Point2d();
-
     /**
      * x of the point, offset in pixels from origin
      */
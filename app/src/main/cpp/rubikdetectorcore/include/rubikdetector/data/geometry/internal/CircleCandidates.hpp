@@ -0,0 +1,99 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_CIRCLECANDIDATES_HPP
+#define RUBIKDETECTOR_CIRCLECANDIDATES_HPP
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "Circle.hpp"
+
+namespace rbdt {
+
+/**
+ * The fields of a list of Circle objects used by the grid matching, stored as one array per field.
+ *
+ * Keeping each field contiguous lets the tests below run on several candidates at once with the OpenCV universal intrinsics, which
+ * map to NEON on the devices & to SSE on the host. When those are not available the same tests run one candidate at a time.
+ *
+ * A candidate is identified by its slot, i.e. its position in the list the buffer was filled from. The arrays are reused between fills.
+ */
+class CircleCandidates {
+public:
+    /**
+     * Replaces the candidates with the given circles, in the same order.
+     */
+    void assign(const std::vector<Circle> &circles);
+
+    /**
+     * Replaces the candidates with the given circles, in the order given by <b>order</b>.
+     *
+     * @param [in] circles the circles to copy
+     * @param [in] order positions in <b>circles</b> of the circles stored at each slot
+     */
+    void assign(const std::vector<Circle> &circles, const std::vector<int> &order);
+
+    int size() const;
+
+    /**
+     * Finds the candidates in the slot range [<b>begin</b>, <b>end</b>) that are close to the reference & look like it. A candidate
+     * is kept when its center is at most <b>maxDistance</b> away from the reference center, neither of the two areas is
+     * <b>maxAreaRatio</b> times the other one or more, and the two angles differ by less than <b>maxAngleDifference</b>.
+     *
+     * @param [in] reference the Circle the candidates are compared with
+     * @param [in] maxDistance in pixels
+     * @param [in] maxAreaRatio ratio between the larger & the smaller area
+     * @param [in] maxAngleDifference in radians
+     * @param [in] begin first slot tested
+     * @param [in] end slot after the last one tested
+     * @param [out] slots receives the slots of the kept candidates, in increasing order. Existing elements are left in place.
+     */
+    void selectSimilar(const Circle &reference, float maxDistance, float maxAreaRatio, float maxAngleDifference,
+                       int begin, int end, std::vector<int> &slots) const;
+
+    /**
+     * Finds the candidates whose square of side 2 * radius, centered on their center, contains the point. This is the same test as
+     * Circle::contains().
+     *
+     * @param [in] point the tested point
+     * @param [out] slots receives the slots of the candidates containing the point, in increasing order
+     */
+    void findContaining(const cv::Point2f &point, std::vector<int> &slots) const;
+
+    /**
+     * Smallest positive gap between the border of the reference & the border of a candidate, measured along the line joining their
+     * centers. Candidates whose center is contained by the reference, or more than <b>maxOffset</b> to the right or below its
+     * center, are ignored.
+     *
+     * @param [in] reference the Circle the gaps are measured from
+     * @param [in] maxOffset in pixels
+     * @param [in] upperBound value returned when no gap is smaller than it
+     * @return the smallest gap, or <b>upperBound</b>
+     */
+    float findSmallestGap(const Circle &reference, float maxOffset, float upperBound) const;
+
+private:
+    void selectSimilarScalar(const Circle &reference, float maxDistance, float maxAreaRatio, float maxAngleDifference,
+                             int begin, int end, std::vector<int> &slots) const;
+
+    void findContainingScalar(const cv::Point2f &point, int begin, std::vector<int> &slots) const;
+
+    float findSmallestGapScalar(const Circle &reference, float maxOffset, float upperBound, int begin) const;
+
+    std::vector<float> centerX;
+
+    std::vector<float> centerY;
+
+    std::vector<float> radius;
+
+    /**
+     * Stored as float, the tests compare it with float thresholds anyway.
+     */
+    std::vector<float> area;
+
+    std::vector<float> angle;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_CIRCLECANDIDATES_HPP
@@ -0,0 +1,82 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_CIRCLEGRIDINDEX_HPP
+#define RUBIKDETECTOR_CIRCLEGRIDINDEX_HPP
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "Circle.hpp"
+#include "CircleCandidates.hpp"
+
+namespace rbdt {
+
+/**
+ * Uniform grid over the centers of a list of Circle objects, used to find the circles close to a point without going through the
+ * whole list.
+ *
+ * The frame is split in CircleGridIndex::CELLS_PER_SIDE x CircleGridIndex::CELLS_PER_SIDE cells. The circles are copied into a
+ * CircleCandidates buffer sorted by cell, so building the index is a counting sort & the cells of one row overlapping the searched
+ * area form a single slot range, which the buffer filters several circles at a time. The arrays are reused between builds.
+ *
+ * The index refers to the circles through their position in the list it was built from, so it needs to be rebuilt whenever that list changes.
+ */
+class CircleGridIndex {
+public:
+    /**
+     * Indexes the circles.
+     *
+     * @param [in] circles the circles to index
+     * @param [in] frameSize size of the frame the circles were found in. Circles centered outside of it go to the border cells.
+     */
+    void build(const std::vector<Circle> &circles, const cv::Size &frameSize);
+
+    /**
+     * Finds the circles at most <b>radius</b> away from the reference that look like it, see CircleCandidates::selectSimilar().
+     *
+     * @param [in] reference the Circle the indexed circles are compared with
+     * @param [in] radius radius of the searched area, in pixels
+     * @param [in] maxAreaRatio ratio between the larger & the smaller area
+     * @param [in] maxAngleDifference in radians
+     * @param [out] indices receives the positions of the found circles in the indexed list, in increasing order
+     */
+    void findSimilarInRadius(const Circle &reference, float radius, float maxAreaRatio, float maxAngleDifference,
+                             std::vector<int> &indices) const;
+
+private:
+    static constexpr int CELLS_PER_SIDE = 16;
+
+    int cellColumn(float x) const;
+
+    int cellRow(float y) const;
+
+    float cellWidth = 1;
+
+    float cellHeight = 1;
+
+    /**
+     * Start of each cell in CircleGridIndex::cellCircles, followed by the total number of circles.
+     */
+    std::vector<int> cellStarts;
+
+    /**
+     * Position in the indexed list of the circle stored at each slot of CircleGridIndex::candidates.
+     */
+    std::vector<int> cellCircles;
+
+    CircleCandidates candidates;
+
+    /**
+     * Scratch space of CircleGridIndex::build().
+     */
+    std::vector<int> nextSlots;
+
+    /**
+     * Scratch space of CircleGridIndex::findSimilarInRadius(), which is why a CircleGridIndex can't be queried from several threads.
+     */
+    mutable std::vector<int> foundSlots;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_CIRCLEGRIDINDEX_HPP
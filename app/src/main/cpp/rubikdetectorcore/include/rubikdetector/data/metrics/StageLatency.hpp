@@ -0,0 +1,117 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_STAGELATENCY_HPP
+#define RUBIKDETECTOR_STAGELATENCY_HPP
+
+#include <cstdint>
+
+namespace rbdt {
+
+/**
+ * The processing stages timed by the RubikProcessor. The declaration order is also the order of the stages in
+ * RubikProcessor::getStageLatencies().
+ */
+enum class ProcessingStage {
+    /**
+     * A whole RubikProcessor::processScan(), RubikProcessor::processPhoto() or RubikProcessor::processColors() call.
+     */
+    FRAME,
+    /**
+     * Sharpness & motion check deciding whether a scan frame gets processed, see RubikProcessor::setScanGateEnabled().
+     */
+    SCAN_GATE,
+    /**
+     * Extraction & downscaling of the luminance data of the photo.
+     */
+    Y_EXTRACTION,
+    /**
+     * Placing the downscaled photo region in the processing frame & rotating it.
+     */
+    CROP_RESIZE_ROTATE,
+    /**
+     * Sampling of the top face. For scan frames this includes the crop, resize & rotation, which are folded into the same lookup.
+     */
+    TOP_FACE_WARP,
+    /**
+     * Sampling of the left face. Same as ProcessingStage::TOP_FACE_WARP.
+     */
+    LEFT_FACE_WARP,
+    /**
+     * Sampling of the right face. Same as ProcessingStage::TOP_FACE_WARP.
+     */
+    RIGHT_FACE_WARP,
+    /**
+     * Noise reduction done by the facelets detector, once per face.
+     */
+    BLUR,
+    /**
+     * Edge detection done by the facelets detector, once per face.
+     */
+    CANNY,
+    /**
+     * Contour extraction done by the facelets detector, once per face.
+     */
+    FIND_CONTOURS,
+    /**
+     * Selection of the contours which could be facelets, once per face.
+     */
+    FILTER_CONTOURS,
+    /**
+     * Search for a 3x3 grid of facelets among the filtered contours, once per face.
+     */
+    GRID_MATCHING,
+    /**
+     * Verification of the grid found in the previous frame, once per face while the facelets detector is tracking the cube.
+     */
+    FACE_TRACKING,
+    /**
+     * Copy of the found facelets to the output buffer.
+     */
+    SAVE_FACELETS,
+    /**
+     * Analysis of the colors of the 54 facelets.
+     */
+    COLOR_ANALYSIS,
+    /**
+     * Number of stages, not a stage itself.
+     */
+    COUNT
+};
+
+/**
+ * Latency statistics of one ProcessingStage, as returned by RubikProcessor::getStageLatencies().
+ *
+ * The percentiles are computed from a histogram with four buckets per doubling of the latency, so they are upper bounds which
+ * overestimate the exact value by less than 19%.
+ */
+struct StageLatency {
+    /**
+     * The timed stage.
+     */
+    ProcessingStage stage;
+
+    /**
+     * Number of times the stage was timed.
+     */
+    uint32_t count;
+
+    /**
+     * Median latency, in milliseconds.
+     */
+    float p50Millis;
+
+    /**
+     * 95th percentile latency, in milliseconds.
+     */
+    float p95Millis;
+
+    /**
+     * 99th percentile latency, in milliseconds.
+     */
+    float p99Millis;
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_STAGELATENCY_HPP
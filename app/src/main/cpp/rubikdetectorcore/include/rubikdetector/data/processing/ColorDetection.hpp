@@ -0,0 +1,32 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_COLORDETECTION_HPP
+#define RUBIKDETECTOR_COLORDETECTION_HPP
+
+#include "RubikFacelet.hpp"
+
+namespace rbdt {
+
+/**
+ * Data class holding the color detected in one image by RubikColorDetector::detectColors().
+ */
+class ColorDetection {
+public:
+    /**
+     * Confidence reported by the detectors which don't measure one, e.g. the default RubikColorDetector::detectColors().
+     */
+    static constexpr float UNKNOWN_CONFIDENCE = -1.0f;
+
+    RubikFacelet::Color color;
+
+    /**
+     * Share of the evidence gathered by the detector which points to ColorDetection::color, in [0, 1], or
+     * ColorDetection::UNKNOWN_CONFIDENCE.
+     */
+    float confidence;
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_COLORDETECTION_HPP
@@ -6,11 +6,16 @@
 #define RUBIKSSCANANDSOLVE_CUBESTATE_H
 
 
-#include <vector>
+#include <array>
 #include <opencv2/core/types.hpp>
 
 namespace rbdt {
 
+    /**
+     * The colors of the whole cube, as found by RubikProcessor::processColors().
+     *
+     * The storage is fixed, so a CubeState is returned by value without any heap allocation.
+     */
     class CubeState {
     public:
 
@@ -18,15 +23,31 @@ namespace rbdt {
             UP, FRONT, RIGHT, DOWN, LEFT, BACK
         };
 
+        static constexpr int FACELET_COUNT = 54;
+
+        static constexpr int FACE_COUNT = 6;
+
+        /**
+         * Creates an invalid CubeState, returned when the colors could not be told apart.
+         */
         CubeState();
 
-        CubeState(std::vector<Face> facelets, std::vector<cv::Scalar> colors);
+        CubeState(const std::array<Face, FACELET_COUNT> &facelets, const std::array<cv::Scalar, FACE_COUNT> &colors);
 
-        ~CubeState();
+        /**
+         * The face each facelet belongs to, judging by its color.
+         */
+        std::array<Face, FACELET_COUNT> facelets;
 
-        std::vector<Face> facelets;
+        /**
+         * The color of each face, in the Face order.
+         */
+        std::array<cv::Scalar, FACE_COUNT> colors;
 
-        std::vector<cv::Scalar> colors;
+        /**
+         * False if the colors could not be told apart, in which case CubeState::facelets & CubeState::colors are meaningless.
+         */
+        bool valid;
     };
 
 } //end namespace rbdt
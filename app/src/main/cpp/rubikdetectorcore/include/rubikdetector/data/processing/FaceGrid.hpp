@@ -0,0 +1,68 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_FACEGRID_HPP
+#define RUBIKDETECTOR_FACEGRID_HPP
+
+#include <array>
+#include <type_traits>
+#include "RubikFacelet.hpp"
+
+namespace rbdt {
+
+/**
+ * Data class holding the 9 facelets of one Rubik's Cube face, as found by a RubikFaceletsDetector.
+ *
+ * The facelets are stored in row major order: the top row is 0, 1 & 2, the middle row 3, 4 & 5, the bottom row 6, 7 & 8, each from left
+ * to right. FaceGrid::at() gives access to them by row & column.
+ *
+ * When the face was not found FaceGrid::found is false, and the facelets & confidences keep their default values.
+ *
+ * The storage is fixed, so a FaceGrid is trivially copyable: it can be returned by value & copied around without any heap allocation.
+ */
+class FaceGrid {
+public:
+
+    static constexpr int FACELET_COUNT = 9;
+
+    /**
+     * Default constructor. The created FaceGrid is not found, and holds default RubikFacelet objects with a confidence of 0.
+     *
+     * @return a FaceGrid constructed as mentioned above.
+     */
+    FaceGrid();
+
+    /**
+     * @param [in] row between 0 & 2, from top to bottom
+     * @param [in] column between 0 & 2, from left to right
+     * @return the facelet at the given row & column
+     */
+    RubikFacelet &at(int row, int column);
+
+    /**
+     * @copydoc FaceGrid::at()
+     */
+    const RubikFacelet &at(int row, int column) const;
+
+    /**
+     * The facelets of the face, in row major order.
+     */
+    std::array<RubikFacelet, FACELET_COUNT> facelets;
+
+    /**
+     * How well each facelet, in the same order, matched a contour of the frame. 0 for a facelet whose position was only estimated from
+     * the other ones, up to 1 for a contour covering it entirely.
+     */
+    std::array<float, FACELET_COUNT> confidence;
+
+    /**
+     * Whether the face was found.
+     */
+    bool found;
+};
+
+static_assert(std::is_trivially_copyable<FaceGrid>::value, "FaceGrid needs to be copyable without heap traffic");
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_FACEGRID_HPP
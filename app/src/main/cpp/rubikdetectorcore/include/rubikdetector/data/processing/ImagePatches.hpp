@@ -0,0 +1,76 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_IMAGEPATCHES_HPP
+#define RUBIKDETECTOR_IMAGEPATCHES_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cv {
+class Mat;
+}
+
+namespace rbdt {
+
+/**
+ * View over images of the same size & type, stored at a fixed distance from each other in a single buffer. The data is not owned.
+ *
+ * The facelets saved by RubikProcessor::processPhoto() at the end of the shared buffer are laid out like this, see
+ * RubikProcessor::getFaceletPatches(). Passing them to RubikColorDetector::detectColors() as a whole avoids building one cv::Mat per
+ * facelet up front.
+ *
+ * The rows of each image are contiguous.
+ */
+class ImagePatches {
+public:
+    /**
+     * Color space of the 3 channel images, so that a RubikColorDetector can tell whether they need converting first.
+     */
+    enum class ColorSpace {
+        BGR, HSV
+    };
+
+    /**
+     * Default constructor. The created ImagePatches holds no images.
+     *
+     * @return an empty ImagePatches.
+     */
+    ImagePatches();
+
+    /**
+     * @param [in] data the first byte of the first image
+     * @param [in] count number of images
+     * @param [in] width width of each image, in pixels
+     * @param [in] height height of each image, in pixels
+     * @param [in] type OpenCV type of the images, e.g. CV_8UC3
+     * @param [in] patchStep distance in bytes between the first bytes of two consecutive images
+     * @param [in] colorSpace color space of the images
+     * @return an ImagePatches over the given images.
+     */
+    ImagePatches(uint8_t *data, int count, int width, int height, int type, size_t patchStep, ColorSpace colorSpace);
+
+    /**
+     * @param [in] index between 0 & ImagePatches::count - 1
+     * @return a cv::Mat header over the image, sharing its data
+     */
+    cv::Mat patch(int index) const;
+
+    uint8_t *data;
+
+    int count;
+
+    int width;
+
+    int height;
+
+    int type;
+
+    size_t patchStep;
+
+    ColorSpace colorSpace;
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_IMAGEPATCHES_HPP
@@ -21,6 +21,8 @@ namespace rbdt {
  * inner circle can also be obtained through RubikFacelet::innerCircleRadius().
  *
  * The color of the facelet is specified through a RubikFacelet::Color. The default color of any facelet is RubikFacelet::Color::WHITE.
+ *
+ * RubikFacelet is trivially copyable, so a FaceGrid can hold them without any heap storage.
  */
 class RubikFacelet {
 public:
@@ -56,24 +58,19 @@ public:
     RubikFacelet(Point2d center, float width, float height, float angle,
                  Color color = Color::WHITE);
 
-    /**
-     * Destructor.
-     */
-    ~RubikFacelet();
-
     /**
      * Computes the 4 corners of the facelet in the input frame, given the known properties of the facelet, and returns them in a vector.
      *
      * @return a std::vector containing 4 Point2d objects, which represent the 4 corners of the facelet.
      */
-    std::vector<Point2d> corners();
+    std::vector<Point2d> corners() const;
 
     /**
      * Computes the radius of the circle centered in the facelet's center of mass, and touches at least two opposite sides of the facelet.
      *
      * @return a float that can be used as the radius of the facelet's inner circle.
      */
-    float innerCircleRadius();
+    float innerCircleRadius() const;
 
     /**
      * A RubikFacelet::Color representing the color of the facelet.
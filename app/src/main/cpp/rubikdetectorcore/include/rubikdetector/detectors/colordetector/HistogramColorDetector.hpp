@@ -67,6 +67,21 @@ public:
                                     const int regionInfo = -1,
                                     const int frameNr = -1) override;
 
+    /**
+     * @copybrief RubikColorDetector::detectColors()
+     *
+     * The images can use the HSV or the BGR color space, see ImagePatches::colorSpace. BGR images are converted to HSV first, all of
+     * them at once when they are stored back to back, into a buffer kept by the detector for the next calls. Concurrent calls
+     * therefore need a detector each. The histograms of every image are built in the same buffers, and nothing is saved for
+     * debugging. The confidence is the share of the white pixels among the non-grayscale ones for RubikFacelet::Color::WHITE, and
+     * the share of the hue evidence which went to the detected color otherwise.
+     *
+     * @copydetails RubikColorDetector::detectColors()
+     */
+    void detectColors(const ImagePatches &patches,
+                      const float whiteRatio,
+                      std::vector<ColorDetection> &detections) override;
+
 private:
     /**
      * Pointer to private implementation (PIMPL Pattern)
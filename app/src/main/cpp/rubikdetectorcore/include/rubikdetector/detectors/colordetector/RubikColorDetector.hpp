@@ -5,8 +5,11 @@
 #ifndef RUBIKDETECTOR_RUBIKCOLORDETECTOR_HPP
 #define RUBIKDETECTOR_RUBIKCOLORDETECTOR_HPP
 
+#include <vector>
 #include "../../processing_templates/ColorDetector.hpp"
 #include "../../data/processing/RubikFacelet.hpp"
+#include "../../data/processing/ImagePatches.hpp"
+#include "../../data/processing/ColorDetection.hpp"
 
 namespace cv {
 class Mat;
@@ -18,6 +21,8 @@ namespace rbdt {
  * The input image is expected to be passed as a cv::Mat parameter to RubikColorDetector::detectColor().
  *
  * The exact method of extraction is implementation specific.
+ *
+ * Several images can also be processed at once through RubikColorDetector::detectColors(), e.g. the 54 facelets of a cube.
  */
 class RubikColorDetector : public ColorDetector<const cv::Mat &, RubikFacelet::Color> {
 public:
@@ -27,6 +32,21 @@ public:
     virtual ~RubikColorDetector() {
 
     };
+
+    /**
+     * Detects the color of every image of <b>patches</b>, e.g. the facelets given by RubikProcessor::getFaceletPatches().
+     *
+     * Implementations can share their setup work between the images, or process several images at once. The default implementation
+     * calls RubikColorDetector::detectColor() on each image, with its index as the region info. Since detectColor() doesn't tell how
+     * sure it is, the confidence is reported as ColorDetection::UNKNOWN_CONFIDENCE.
+     *
+     * @param [in] patches the images. Implementations state which ImagePatches::ColorSpace they accept
+     * @param [in] whiteRatio see RubikColorDetector::detectColor()
+     * @param [out] detections receives the color detected in each image, in the same order. Resized to the number of images.
+     */
+    virtual void detectColors(const ImagePatches &patches,
+                              const float whiteRatio,
+                              std::vector<ColorDetection> &detections);
 };
 
 } //end namespace rbdt
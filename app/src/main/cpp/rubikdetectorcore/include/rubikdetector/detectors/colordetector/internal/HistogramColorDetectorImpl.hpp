@@ -7,13 +7,11 @@
 
 #include <vector>
 #include <memory>
+#include <opencv2/core/core.hpp>
 #include "../../../imagesaver/ImageSaver.hpp"
 #include "../../../data/processing/RubikFacelet.hpp"
 #include "../RubikColorDetector.hpp"
 
-namespace cv {
-class Mat;
-}
 namespace rbdt {
 /**
  * Class to which a HistogramColorDetector delegates its work to.
@@ -75,6 +73,13 @@ public:
                                     const int regionInfo = -1,
                                     const int frameNr = -1) override;
 
+    /**
+     * @copydoc HistogramColorDetector::detectColors()
+     */
+    void detectColors(const ImagePatches &patches,
+                      const float whiteRatio,
+                      std::vector<ColorDetection> &detections) override;
+
 private:
 
     /**
@@ -90,29 +95,42 @@ private:
                            const int frameNumber, const int regionId) const;
 
     /**
-     * Creates a histogram for the staturation. Only pixels that satisfy the below conditions will be counted:
+     * Builds the saturation & the hue histograms of the image in a single pass over its interleaved HSV pixels, without splitting
+     * the channels.
+     *
+     * The saturation histogram only counts the pixels that satisfy the below conditions:
      *   - pixels with a saturation value below HistogramColorDetectorImpl::SATURATION_THRESHOLD (i.e. with not enough color)
      *   - pixels with a value above HistogramColorDetectorImpl::MIN_HSV_VALUE_FOR_WHITE (i.e. with enough light to be white,
      *   or a very light gray, but gray or dark gray)
      *
-     * All other pixels are regarded as being either colored pixels, or grayscale pixels, and not added to the histogram.
+     * The hue histogram only counts the non-grayscale pixels, i.e. with a value above HistogramColorDetectorImpl::MIN_HSV_VALUE_NON_GRAY.
+     * These are also counted & returned as the <b>nrNonGrayPixels</b> out parameter.
      *
-     * Non-grayscale pixels, are also counted & returned as the <b>nrNonGrayPixels</b> in/out parameter.
+     * The pixels are counted without branches, 4 at a time.
      *
-     * @param [in] hsvChannels a std::vector of 3 elements. Each needs to represent a channel of the original HSV frame in which detection is performed.
-     * The Hue component is expected to be index 0, Saturation at index 1 & Value at index 2.
-     * @param [in/out] saturationHistogram the array in which the histogram will be written
-     * @param [in/out] nrNonGrayPixels the number of non-grayscale pixels.
+     * @param [in] image the HSV image in which detection is performed
+     * @param [out] saturationHistogram SATURATION_HISTOGRAM_SIZE values
+     * @param [out] hueHistogram HUE_BUFFER_SIZE values. Only the first HUE_HISTOGRAM_SIZE are meaningful.
+     * @param [out] nrNonGrayPixels the number of non-grayscale pixels.
      */
-    void computeSaturationHistogram(const std::vector<cv::Mat> &hsvChannels,
-                                    int *saturationHistogram,
-                                    int &nrNonGrayPixels) const;
+    void computeHistograms(const cv::Mat &image,
+                           int *saturationHistogram,
+                           int *hueHistogram,
+                           int &nrNonGrayPixels) const;
 
-    static constexpr int HUE = 0;
-
-    static constexpr int SATURATION = 1;
-
-    static constexpr int VALUE = 2;
+    /**
+     * Picks the color of an image from its histograms, see computeHistograms().
+     *
+     * @param [out] isWhite set to true when the color was picked from the saturation histogram
+     * @param [out] confidence the share of the white pixels among the non-grayscale ones for white, or the share of the hue evidence
+     * which went to the picked color otherwise
+     */
+    RubikFacelet::Color classify(const int *saturationHistogram,
+                                 const int *hueHistogram,
+                                 const int nrNonGrayPixels,
+                                 const float whiteRatio,
+                                 bool &isWhite,
+                                 float &confidence) const;
 
     static constexpr int MIN_HSV_VALUE_NON_GRAY = 80;
 
@@ -124,6 +142,12 @@ private:
 
     static constexpr int HUE_HISTOGRAM_SIZE = 180;
 
+    /**
+     * Every pixel increments a hue bin, with 0 or 1. The buffer covers all 8 bit values so that no bin can be out of range, even
+     * for an image that was not converted with hues in [0, 180).
+     */
+    static constexpr int HUE_BUFFER_SIZE = 256;
+
     static constexpr int BUCKET_ORANGE_MIN_THRESHOLD = 4;
 
     static constexpr int BUCKET_ORANGE_MAX_THRESHOLD = 18;
@@ -149,6 +173,11 @@ private:
     static constexpr int BUCKET_RED_MAX_THRESHOLD_2 = 4;
 
     std::shared_ptr<ImageSaver> imageSaver;
+
+    /**
+     * HSV copy of the BGR patches given to detectColors(), one patch after the other. Kept between calls so its storage is reused.
+     */
+    cv::Mat hsvPatches;
 };
 
 } //namespace rbdt
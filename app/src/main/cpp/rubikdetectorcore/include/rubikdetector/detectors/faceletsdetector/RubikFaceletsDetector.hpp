@@ -7,7 +7,7 @@
 
 #include <cstdint>
 #include "../../processing_templates/GenericDetector.hpp"
-#include "../../data/processing/RubikFacelet.hpp"
+#include "../../data/processing/FaceGrid.hpp"
 
 namespace cv {
 class Mat;
@@ -18,13 +18,27 @@ namespace rbdt {
  * @brief Interface which defines a component capable of detecing the presence of a Rubik's Cube face in an image, and
  * capable of returning the facelets of the visible cube face, when found.
  *
- * The input image is expected to be passed as a cv::Mat parameter to FaceletsDetector::detect(). When a result is found,
- * a 3x3 std::vector of RubikFacelet elements is returned.
+ * The input image is expected to be passed as a cv::Mat parameter to FaceletsDetector::detect(), which returns a FaceGrid. When a
+ * result is found, FaceGrid::found is set & the grid holds the 9 RubikFacelet elements of the face.
+ *
+ * The RubikProcessor detects the three visible faces of the cube in parallel, hence implementations need to support concurrent
+ * calls to detect() on different frames. RubikFaceletsDetector::onFrameSizeSelected() is never called while a detection is running.
  */
-class RubikFaceletsDetector : public GenericDetector<cv::Mat &, std::vector<std::vector<RubikFacelet>>> {
+class RubikFaceletsDetector : public GenericDetector<cv::Mat &, FaceGrid> {
 public:
 
     virtual ~RubikFaceletsDetector() {}
+
+    /**
+     * Same as detect(), for an image unrelated to the previous ones with the same tag, e.g. a photo taken in between scan frames.
+     * Detectors which carry state from one call to the next, like the tracking of SimpleFaceletsDetector, neither use nor update
+     * that state here.
+     *
+     * The default implementation calls detect(), for detectors which don't keep any state.
+     */
+    virtual FaceGrid detectUntracked(cv::Mat &inputFrame, const std::string &tag, const int frameNumber = 0) {
+        return detect(inputFrame, tag, frameNumber);
+    }
 };
 } //end namespace rbdt
 #endif //RUBIKDETECTOR_FACELETSDETECTOR_HPP
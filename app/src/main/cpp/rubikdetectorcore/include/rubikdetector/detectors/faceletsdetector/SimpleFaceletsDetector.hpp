@@ -8,7 +8,7 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
-#include "../../data/processing/RubikFacelet.hpp"
+#include "../../data/processing/FaceGrid.hpp"
 #include "RubikFaceletsDetector.hpp"
 
 namespace cv {
@@ -27,10 +27,19 @@ namespace rbdt {
  * Concrete implementation of a RubikFaceletsDetector.
  *
  * This object requires its RubikFaceletsDetector::onFrameSizeSelected() method to be called before any call to detect() is made. Failing to call onFrameSizeSelected() at least once,
- * or when the size of the input frame changes, will cause undefined behavior.
+ * or when the size of the input frame changes, will cause undefined behavior. The pixel sizes used by the detection (shape areas, blur & Canny
+ * kernels, margins) were tuned on 360x360 frames, and are scaled to the size given there.
  *
  * The cv::Mat passed to SimpleFaceletsDetector::detect() needs to be a <b>1 channel grayscale image.</b>
  *
+ * SimpleFaceletsDetector::detect() can be called concurrently as long as each call works on its own cv::Mat & uses its own tag. The input
+ * cv::Mat is used as scratch memory and is modified in place.
+ *
+ * By default the detector tracks the cube: it remembers the last grid found for each tag, and on the next call with the same tag it first
+ * looks for the facelets only around their previous positions. The full detection only runs when that verification fails. Since the cube
+ * barely moves between consecutive frames, this makes the detection of an already found cube much cheaper. See
+ * SimpleFaceletsDetector::setTrackingEnabled().
+ *
  * Enabling the debug mode on this component makes it print information relevant for debugging. If a non-null ImageSaver is also provided through the
  * appropriate constructor, then various processing artifacts & images are saved for debugging purposes, when debugging is turned on. However, performance is drastically
  * reduced when the images are saved, since writing to disk is typically very slow.
@@ -59,17 +68,32 @@ namespace rbdt {
 
         /**
          * Searches for a Rubik's Cube face in the given grayscale cv::Mat. If a cube face is found, then it returns
-         * a 3x3 std::vector of RubikFacelet objects, representing the found facelets, without color.
+         * a found FaceGrid holding the RubikFacelet objects which represent the found facelets, without color.
+         *
+         * If no facelets are found, then the returned FaceGrid is not found.
          *
-         * If no facelets are found, then nullptr is returned.
+         * The containers used while searching for the face are kept by the detector & reused by the following calls, so once the detector
+         * warmed up it doesn't allocate by itself; OpenCV still allocates inside the edge & contour detection.
+         */
+        virtual FaceGrid detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber = 0) override;
+
+        /**
+         * Runs the full detection, whether tracking is enabled or not, and leaves the grids remembered for tracking untouched.
          */
-        virtual std::vector<std::vector<RubikFacelet>> detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber = 0) override;
+        FaceGrid detectUntracked(cv::Mat &frameGray, const std::string &tag, const int frameNumber = 0) override;
 
         /**
          * @copydoc GenericDetector::onFrameSizeSelected
          */
         void onFrameSizeSelected(int dimension) override;
 
+        /**
+         * Enables or disables tracking. Disabling it also forgets the grids found so far, so every following call runs the full detection.
+         *
+         * @param [in] enabled true to verify the previously found grids before falling back to the full detection. The default.
+         */
+        void setTrackingEnabled(bool enabled);
+
     private:
         /**
          * Pointer to private implementation (PIMPL Pattern)
@@ -7,19 +7,25 @@
 
 #include <opencv2/core/core.hpp>
 #include "../../../data/geometry/internal/Circle.hpp"
+#include "../../../data/geometry/internal/CircleCandidates.hpp"
+#include "../../../data/geometry/internal/CircleGridIndex.hpp"
 #include "../../../data/processing/internal/HueColorEvidence.hpp"
 #include "../../colordetector/HistogramColorDetector.hpp"
 #include "../../../imagesaver/ImageSaver.hpp"
 #include "../RubikFaceletsDetector.hpp"
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace rbdt {
 
 class OnCubeDetectionResultListener;
 
-class RubikFacelet;
-
 /**
  * Class to which a SimpleFaceletsDetector delegates its work to.
  *
@@ -75,23 +81,127 @@ public:
     /**
      * @copydoc SimpleFaceletsDetector::detect()
      */
-    std::vector<std::vector<RubikFacelet>> detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber = 0) override;
+    FaceGrid detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber = 0) override;
+
+    /**
+     * @copydoc SimpleFaceletsDetector::detectUntracked()
+     */
+    FaceGrid detectUntracked(cv::Mat &frameGray, const std::string &tag, const int frameNumber = 0) override;
 
     /**
      * @copydoc SimpleFaceletsDetector::onFrameSizeSelected()
      */
     void onFrameSizeSelected(int processingDimension) override;
 
+    /**
+     * @copydoc SimpleFaceletsDetector::setTrackingEnabled()
+     */
+    void setTrackingEnabled(bool enabled);
+
 private:
 
+    /**
+     * Every container used by one detection, kept between detections so their storage is reused.
+     */
+    struct DetectionScratch {
+        cv::Mat blurredFrame;
+
+        cv::Mat trackingEdges;
+
+        std::vector<std::vector<cv::Point>> contours;
+
+        std::vector<cv::Vec4i> hierarchy;
+
+        std::vector<cv::RotatedRect> filteredRectangles;
+
+        std::vector<Circle> innerCircles;
+
+        CircleGridIndex innerCirclesIndex;
+
+        std::vector<int> neighbours;
+
+        std::vector<Circle> potentialFacelets;
+
+        CircleCandidates potentialCandidates;
+
+        std::vector<Circle> estimatedFacelets;
+
+        std::vector<int> containingFacelets;
+
+        std::array<Circle, 9> facetModel;
+
+        /**
+         * Part of the matched contour covered by each facelet of DetectionScratch::facetModel, 0 where none was matched.
+         */
+        std::array<float, 9> overlaps;
+
+        std::vector<Circle> previousFacelets;
+
+        std::vector<Circle> trackedFacelets;
+    };
+
+    /**
+     * Takes a DetectionScratch out of SimpleFaceletsDetectorImpl::freeScratches, or creates one if none is free.
+     */
+    std::unique_ptr<DetectionScratch> acquireScratch();
+
+    /**
+     * Returns the DetectionScratch to SimpleFaceletsDetectorImpl::freeScratches, for the next detection to use.
+     */
+    void releaseScratch(std::unique_ptr<DetectionScratch> scratch);
+
+    /**
+     * Does the work of detect() & detectUntracked(), with the containers of the given DetectionScratch.
+     *
+     * @param [in] tracking false to skip both the verification of the remembered grid & the update of it
+     */
+    FaceGrid detectWithScratch(cv::Mat &frameGray,
+                               const std::string &tag,
+                               const int frameNumber,
+                               const bool tracking,
+                               DetectionScratch &scratch);
+
+    /**
+     * Searches for the facelets of the previously found grid only inside the bounding box of that grid, grown by
+     * SimpleFaceletsDetectorImpl::TRACKING_SEARCH_MARGIN. The region is processed out of place, so <b>frameGray</b> is left untouched
+     * for the full detection if the verification fails.
+     *
+     * The grid is considered found if enough of the previous facelets overlap a contour of the current frame, with the same criteria
+     * used by the full detection. The facelets which were not matched are moved along with the ones that were.
+     *
+     * @param [in] frameGray a 1 channel grayscale cv::Mat
+     * @param [in/out] scratch holds the 9 facelets of the previously found grid, in row major order, in DetectionScratch::previousFacelets.
+     * Receives the 9 facelets of the grid in this frame, in the same order, in DetectionScratch::trackedFacelets if found, and how
+     * much each one overlaps its contour in DetectionScratch::overlaps. The facelets which were moved have an overlap of 0.
+     * @return true if the grid was found again
+     */
+    bool trackFace(const cv::Mat &frameGray, DetectionScratch &scratch) const;
+
+    /**
+     * Remembers the grid found for the given tag, or forgets the previous one if <b>facelets</b> is empty.
+     *
+     * Does not allocate once a grid was remembered for the tag.
+     */
+    void updateTrackedFace(const std::string &tag, const std::vector<Circle> &facelets);
+
+    /**
+     * @return true if every facelet of the face model lies entirely inside the frame
+     */
+    bool isInsideFrame(const FaceGrid &faceGrid, const cv::Mat &frameGray) const;
+
     /**
      * Applies basic pre-processing on the frame (e.g. blur) and then extracts the contours present in the frame
      * by using the Canny Edge detector implemented in OpenCV.
      *
-     * @param [in] frameGray a 1 channel grayscale cv::Mat
-     * @return a 2d std::vector containing a contour on each row, & the columns being the points present on the respective contour
+     * @param [in,out] frameGray a 1 channel grayscale cv::Mat, which receives the edges
+     * @param [out] blurredFrame receives the blurred frame. Reused between calls, so it doesn't reallocate while the frame size stays the same
+     * @param [out] contours receives a contour on each row, & the columns being the points present on the respective contour
+     * @param [out] hierarchy scratch space of cv::findContours()
      */
-    std::vector<std::vector<cv::Point>> detectContours(const cv::Mat &frameGray) const;
+    void detectContours(cv::Mat &frameGray,
+                        cv::Mat &blurredFrame,
+                        std::vector<std::vector<cv::Point>> &contours,
+                        std::vector<cv::Vec4i> &hierarchy) const;
 
     /**
      * Iterates over the contour list and adds the rotated rectangles that passed the filtering step, together with their Circle representation, to their
@@ -118,10 +228,16 @@ private:
      * a buffer.
      *
      * @param [in] referenceCircle a Circle representing the reference circle
-     * @param [in] validCircles a std::vector of Circle object which are potential facelets, given the current reference Circle
+     * @param [in] validCircles the potential facelets, given the current reference Circle
      * @return a float representing the computed margin
      */
-    float computeMargin(Circle referenceCircle, std::vector<Circle> validCircles);
+    float computeMargin(const Circle &referenceCircle, const CircleCandidates &validCircles) const;
+
+    /**
+     * @param [in] apertureSize 3, 5 or 7
+     * @return how much the Sobel kernel of the given size, as used by cv::Canny(), amplifies a gradient
+     */
+    static float sobelGain(int apertureSize);
 
     /**
      * Since the faces will now always be oriented with the image we can estimate the position of the facelet based on the position of
@@ -130,20 +246,39 @@ private:
      * @param validCircles
      * @return
      */
-    int estimatePositionOfFacelet(Circle referenceCircle,std::vector<Circle> validCircles);
+    int estimatePositionOfFacelet(const Circle &referenceCircle, const std::vector<Circle> &validCircles) const;
 
     /**
      * Further filters the list of Circle elements, s.t. after this filtering only Circles of area & orientation similar to the
      * reference Circle will be considered valid.
      *
+     * Only the Circles close enough to the reference to be part of the same face are considered, see
+     * SimpleFaceletsDetectorImpl::computeFaceReach(). They are looked up & compared through the index instead of going through the
+     * whole list.
+     *
      * @param [in] referenceCircle Circle considered as the reference
      * @param [in] innerCircles std::vector of Circle elements that will be filtered
+     * @param [in] innerCirclesIndex a CircleGridIndex built from <b>innerCircles</b>
      * @param [in] referenceCircleIndex the index of the reference Circle, in the overall Circle list
-     * @return a std::vector which only contains Circles higly similar to the reference circle
+     * @param [out] neighbours scratch space for the index lookup
+     * @param [out] foundCircles receives only the Circles higly similar to the reference circle
+     */
+    void findPotentialFacelets(const Circle &referenceCircle,
+                               const std::vector<Circle> &innerCircles,
+                               const CircleGridIndex &innerCirclesIndex,
+                               int referenceCircleIndex,
+                               std::vector<int> &neighbours,
+                               std::vector<Circle> &foundCircles) const;
+
+    /**
+     * Distance from the reference Circle beyond which no facelet of the same face can be. The farthest facelet is two rows & two columns
+     * away, spaced by at most a diameter and the largest margin computeMargin() can return. The facelet matched there can be slightly
+     * bigger than the reference, and only needs to contain the estimated center.
+     *
+     * @param [in] referenceCircle Circle considered as the reference
+     * @return the distance, in pixels
      */
-    std::vector<Circle> findPotentialFacelets(const Circle &referenceCircle,
-                                              const std::vector<Circle> &innerCircles,
-                                              int referenceCircleIndex) const;
+    float computeFaceReach(const Circle &referenceCircle) const;
 
     /**
      * Given the reference Circle, its orientation, and the value for a margin between circles, this method
@@ -151,10 +286,11 @@ private:
      *
      * @param [in] referenceCircle a Circle representing the reference object
      * @param [in] margin the margin that will be used to position the remaining 8 circles, relative to the reference one
-     * @return a std::vector containing 8 estimated facelets positions, represented as Circle objects, for the
+     * @param [out] newCircles receives the estimated facelets positions, represented as Circle objects, for the
      * reference Circle received as a parameter
      */
-    std::vector<Circle> estimateRemainingFaceletsPositions(const Circle &referenceCircle, float margin, int position) const;
+    void estimateRemainingFaceletsPositions(const Circle &referenceCircle, float margin, int position,
+                                            std::vector<Circle> &newCircles) const;
 
     /**
      * Given the list of estimated (or generated) facelets, searches for overlaps with Circles which represent real contours
@@ -164,38 +300,45 @@ private:
      * to the result 2D array, at the row & column it represents on the Rubik's Cube face.
      *
      * @param [in] potentialFacelets std::vector of Circle objects representing potential facelets which have passed the previous two filtering rounds
+     * @param [in] potentialCandidates the same facelets, filled from <b>potentialFacelets</b>
      * @param [in] estimatedFacelets std::vector of Circle objects generated from a reference Circle, and an empirical margin
-     * @return a 2D array representing an incomplete model of a Rubik's Cube face. The model is composed from Circles from the <b>potentialFacelets</b>
-     * which were matched with estimated Circle objects.
+     * @param [out] containingFacelets scratch space for the containment test
+     * @param [out] facetModel receives an incomplete model of a Rubik's Cube face, in row major order. The model is composed from Circles
+     * from the <b>potentialFacelets</b> which were matched with estimated Circle objects, and empty Circle objects elsewhere.
+     * @param [out] overlaps receives the part of each matched potential facelet covered by its estimated facelet, at most 1, or 0 where
+     * nothing was matched
      */
-    std::vector<std::vector<Circle>> matchEstimatedWithPotentialFacelets(
-            const std::vector<Circle> &potentialFacelets,
-            const std::vector<Circle> &estimatedFacelets);
+    void matchEstimatedWithPotentialFacelets(const std::vector<Circle> &potentialFacelets,
+                                             const CircleCandidates &potentialCandidates,
+                                             const std::vector<Circle> &estimatedFacelets,
+                                             std::vector<int> &containingFacelets,
+                                             std::array<Circle, 9> &facetModel,
+                                             std::array<float, 9> &overlaps) const;
 
     /**
-     * Asserts whether the input 2D array of facelets is complete enough to unambiguously define a Rubik's Cube facet.
-     * @param [in] cubeFacet a 2D std::vector representing an incomplete model of a Rubik's Cube facet.
+     * Asserts whether the input array of facelets is complete enough to unambiguously define a Rubik's Cube facet.
+     * @param [in] cubeFacet an incomplete model of a Rubik's Cube facet, in row major order.
      * @return <b>true</b> if the model is sufficient to define a Rubik's Facet, <b>false</b> otherwise.
      */
-    bool verifyIfFaceFound(const std::vector<std::vector<Circle>> &cubeFacet) const;
+    bool verifyIfFaceFound(const std::array<Circle, 9> &cubeFacet) const;
 
     /**
      * Fills with estimated facelets the missing facelets in an incomplete Rubik's Cube facet model.
      *
      * @param [in] estimatedFacelets std::vector of Circle objects representing the estimated facelets
-     * @param [in/out] facetModel 2d std::vector representing an incomplete Rubik's Cube facet mode, to be
+     * @param [in/out] facetModel an incomplete Rubik's Cube facet model in row major order, to be
      * completed by the estimated facelets
      */
     void fillMissingFacelets(const std::vector<Circle> &estimatedFacelets,
-                             std::vector<std::vector<Circle>> &facetModel);
+                             std::array<Circle, 9> &facetModel) const;
 
     /**
-     * Creates a Rubik's Cube facet model made of RubikFacelet objects, from a model composed from Circle objects.
-     * @param [in] model complete Rubik's Cube facet model, composed from Circle objects
-     * @return an equivalent Rubik's Cube facet model, made of RubikFacelet objects
+     * Creates a found FaceGrid from a complete model composed from Circle objects.
+     * @param [in] model complete Rubik's Cube facet model, composed from Circle objects, in row major order
+     * @param [in] overlaps the overlap of each facelet of the model, used as its FaceGrid::confidence
+     * @return the equivalent FaceGrid
      */
-    std::vector<std::vector<RubikFacelet>> createResult(
-            const std::vector<std::vector<Circle>> &model);
+    FaceGrid createResult(const std::array<Circle, 9> &model, const std::array<float, 9> &overlaps) const;
 
     void saveWholeFrame(const cv::Mat &currentFrame, int frameNr, const std::string &tag) const;
 
@@ -208,15 +351,26 @@ private:
                        const std::vector<Circle> &potentialFacelets,
                        const std::vector<Circle> &estimatedFacelets,
                        const int frameNumber,
-                       const std::string &tag);
+                       const std::string &tag) const;
 
     void drawRectangleToMat(const cv::Mat &currentFrame, const cv::RotatedRect &rotatedRect,
                             const cv::Scalar color = cv::Scalar(0, 255, 0)) const;
 
+    /**
+     * Face size, in pixels, for which the constants below which are measured in pixels were tuned. onFrameSizeSelected() scales them
+     * to the actual face size.
+     */
+    static constexpr int REFERENCE_DIMENSION = 360;
+
     static constexpr float MIN_VALID_SHAPE_TO_IMAGE_AREA_RATIO = 3.0f;
 
     static constexpr int CIRCLE_DISTANCE_BUFFER = 2 * 10;
 
+    /**
+     * Margin between facelets used when computeMargin() can't measure one.
+     */
+    static constexpr float FALLBACK_MARGIN = 10.0f;
+
     static constexpr int BLUR_KERNEL_SIZE = 7;
 
     static constexpr int CANNY_LOW_THRESHOLD = 100;
@@ -227,10 +381,72 @@ private:
 
     static constexpr int MIN_POTENTIAL_FACELETS_REQUIRED = 4;
 
+    /**
+     * Largest ratio between the areas of a potential facelet & the reference one.
+     */
+    static constexpr float MAX_POTENTIAL_FACELET_AREA_RATIO = 1.5f;
+
+    /**
+     * Largest difference between the angles of a potential facelet & the reference one, 35 degrees.
+     */
+    static constexpr float MAX_POTENTIAL_FACELET_ANGLE_DIFFERENCE = (float) (35 * CV_PI / 180);
+
+    /**
+     * How much the tracked grid can move between two frames, as a fraction of the size of a facelet.
+     */
+    static constexpr float TRACKING_SEARCH_MARGIN = 0.5f;
+
     std::shared_ptr<ImageSaver> imageSaver;
 
     int minValidShapeArea;
 
+    /**
+     * SimpleFaceletsDetectorImpl::CIRCLE_DISTANCE_BUFFER, scaled to the current face size.
+     */
+    float circleDistanceBuffer;
+
+    /**
+     * SimpleFaceletsDetectorImpl::FALLBACK_MARGIN, scaled to the current face size.
+     */
+    float fallbackMargin;
+
+    /**
+     * SimpleFaceletsDetectorImpl::BLUR_KERNEL_SIZE, scaled to the current face size & kept odd.
+     */
+    int blurKernelSize;
+
+    /**
+     * SimpleFaceletsDetectorImpl::CANNY_APERTURE_SIZE, scaled to the current face size. Never more than 7.
+     */
+    int cannyApertureSize;
+
+    /**
+     * SimpleFaceletsDetectorImpl::CANNY_LOW_THRESHOLD, compensated for the gain of SimpleFaceletsDetectorImpl::cannyApertureSize.
+     */
+    double cannyLowThreshold;
+
+    std::atomic<bool> trackingEnabled;
+
+    /**
+     * Guards SimpleFaceletsDetectorImpl::trackedFaces, which is shared by the calls detecting the different faces.
+     */
+    std::mutex trackingMutex;
+
+    /**
+     * Last grid found for each tag, as 9 facelets in row major order. Empty if the grid was lost.
+     */
+    std::map<std::string, std::vector<Circle>> trackedFaces;
+
+    /**
+     * Guards SimpleFaceletsDetectorImpl::freeScratches.
+     */
+    std::mutex scratchMutex;
+
+    /**
+     * The DetectionScratch objects not used by a running detection. There are as many of them as detections ever ran at the same time.
+     */
+    std::vector<std::unique_ptr<DetectionScratch>> freeScratches;
+
 };
 
 } //namespace rbdt
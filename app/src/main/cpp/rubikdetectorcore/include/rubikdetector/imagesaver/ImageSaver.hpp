@@ -5,6 +5,7 @@
 #ifndef RUBIKDETECTOR_IMAGESAVER_HPP
 #define RUBIKDETECTOR_IMAGESAVER_HPP
 
+#include <memory>
 #include <string>
 
 namespace cv {
@@ -12,26 +13,71 @@ class Mat;
 }
 namespace rbdt {
 
+class AsyncImageWriter;
+
 /**
  * Object capable of saving arbitrary cv::Mat objects to disk, primarily for debugging purposes.
+ *
+ * By default images are encoded & written synchronously, on the calling thread. When created with a queue capacity, the
+ * ImageSaver copies the images and hands them to a background writer thread instead. If the writer falls behind, the oldest
+ * queued images are dropped, so saving debug images never stalls the processing.
+ *
+ * A ImageSaver created through the default constructor is disabled, and ignores every image it receives.
  */
 class ImageSaver {
 public:
+    /**
+     * Encodings available for the saved images.
+     */
+    enum class Format {
+        /**
+         * Lossy, smallest files. The default.
+         */
+        JPEG,
+        /**
+         * Lossless.
+         */
+        PNG,
+        /**
+         * Raw dump of the cv::Mat data in the NumPy .npy format, with shape (rows, cols, channels).
+         */
+        NPY
+    };
+
+    /**
+     * Creates a disabled ImageSaver, on which ImageSaver::saveImage() does nothing.
+     * @return a ImageSaver
+     */
+    ImageSaver();
+
     /**
      * Constructor.
      * @param [in] saveLocation a std::string poiting to a local storage location where write access is granted. This is where the
      * saved frames will be saved.
+     * @param [in] format the encoding of the saved images
+     * @param [in] queueCapacity maximum number of images waiting to be written by the background writer thread. If 0, images
+     * are written synchronously & no thread is started.
      * @return a ImageSaver
      */
-    ImageSaver(const std::string saveLocation);
+    ImageSaver(const std::string saveLocation, const Format format = Format::JPEG, const int queueCapacity = 0);
 
     /**
-     * Empty destructor. Used just for printing when debuggable.
+     * Writes the images still queued, if asynchronous, then stops the writer thread.
      */
     ~ImageSaver();
 
     /**
-     * Save the parameter cv::Mat as a JPEG with name "pic_<frameNumber>_<regionId>.jpeg".
+     * @return false if this ImageSaver was created disabled, true otherwise
+     */
+    bool isEnabled() const;
+
+    /**
+     * Blocks until all the images queued so far are written. Returns immediately if the ImageSaver is synchronous or disabled.
+     */
+    void flush();
+
+    /**
+     * Save the parameter cv::Mat with name "pic_<frameNumber>_<regionId>.<extension>", the extension depending on the Format.
      *
      * @param [in] mat the cv::Mat to be saved
      * @param [in] frameNumber the frame number to which this cv::Mat belongs to
@@ -42,19 +88,40 @@ public:
     bool saveImage(const cv::Mat &mat, const int frameNumber, const int regionName);
 
     /**
-     * Save the parameter cv::Mat as a JPEG with name "pic_<frameNumber>_<regionId>.jpeg".
+     * Save the parameter cv::Mat with name "pic_<frameNumber>_<regionId>.<extension>", the extension depending on the Format.
      *
      * @param [in] mat the cv::Mat to be saved
      * @param [in] frameNumber the frame number to which this cv::Mat belongs to
      * @param [in] regionId a std::string capable of uniquelly identifying this image among other saved images,
      * that have the same frameNumber (i.e. have been extracted from the same Frame)
-     * @return true if saving was successful, false otherwise
+     * @return true if saving was successful, false otherwise. When asynchronous, true if the image was queued without dropping
+     * an older one.
      */
     bool saveImage(const cv::Mat &mat, const int frameNumber, const std::string regionName);
 
 private:
+    static const char *fileExtension(const Format format);
+
+    static bool encode(const std::string &filePath, const cv::Mat &mat, const Format format);
+
+    static bool writeNpy(const std::string &filePath, const cv::Mat &mat);
+
+    const bool enabled;
+
     const std::string path;
+
+    const Format format;
+
+    std::unique_ptr<AsyncImageWriter> asyncWriter;
 };
 
+/**
+ * Guard for the debug output: building the debug images is only worth it if there is an enabled ImageSaver to save them.
+ *
+ * @param [in] imageSaver may be null
+ * @return true if <b>imageSaver</b> is set & ImageSaver::isEnabled()
+ */
+bool isSavingImages(const std::shared_ptr<ImageSaver> &imageSaver);
+
 } //end namespace rbdt
 #endif //RUBIKDETECTOR_IMAGESAVER_HPP
@@ -0,0 +1,90 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_ASYNCIMAGEWRITER_HPP
+#define RUBIKDETECTOR_ASYNCIMAGEWRITER_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <opencv2/core/core.hpp>
+#include "../../utils/BoundedQueue.hpp"
+
+namespace rbdt {
+
+/**
+ * Background writer used by an asynchronous ImageSaver.
+ *
+ * Images are copied & queued by the calling thread, then encoded and written to disk by a single writer thread. The queue is bounded,
+ * when the writer falls behind the oldest queued image is dropped, so saving never blocks the processing threads.
+ *
+ * @warning Do not use AsyncImageWriter directly, do not expose this in the API. Use ImageSaver instead.
+ */
+class AsyncImageWriter {
+public:
+    /**
+     * Encodes & writes one image to the given path. Returns true if successful.
+     */
+    typedef std::function<bool(const std::string &filePath, const cv::Mat &mat)> Encoder;
+
+    /**
+     * Starts the writer thread.
+     *
+     * @param [in] capacity maximum number of images waiting to be written
+     * @param [in] encoder used by the writer thread for each image
+     * @return a AsyncImageWriter
+     */
+    AsyncImageWriter(int capacity, Encoder encoder);
+
+    /**
+     * Writes the images still in the queue, then joins the writer thread.
+     */
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter &) = delete;
+
+    AsyncImageWriter &operator=(const AsyncImageWriter &) = delete;
+
+    /**
+     * Queues a copy of the image, so the caller is free to reuse <b>mat</b> as soon as this returns.
+     *
+     * @return false if an older image had to be dropped to make room for this one, true otherwise
+     */
+    bool enqueue(const std::string &filePath, const cv::Mat &mat);
+
+    /**
+     * Blocks until all the queued images have been written.
+     */
+    void flush();
+
+private:
+
+    struct PendingImage {
+        std::string filePath;
+        cv::Mat mat;
+    };
+
+    void writerLoop();
+
+    void onImageDone();
+
+    Encoder encoder;
+
+    BoundedQueue<PendingImage> pendingImages;
+
+    std::mutex pendingMutex;
+
+    std::condition_variable allWritten;
+
+    int pendingCount = 0;
+
+    int droppedCount = 0;
+
+    std::thread writerThread;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_ASYNCIMAGEWRITER_HPP
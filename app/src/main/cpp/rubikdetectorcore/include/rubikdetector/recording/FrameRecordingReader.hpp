@@ -0,0 +1,100 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_FRAMERECORDINGREADER_HPP
+#define RUBIKDETECTOR_FRAMERECORDINGREADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "FrameRole.hpp"
+#include "../data/config/ImageProperties.hpp"
+#include "internal/FrameRecordingFormat.hpp"
+
+namespace rbdt {
+
+/**
+ * Gives read only access to the frames of a recording written by a FrameRecordingWriter.
+ *
+ * The whole file is mapped in memory when opened, so the frames are never copied: FrameRecordingReader::getFrame() returns pointers
+ * straight into the mapping, which the kernel pages in on first access. This keeps replaying large recordings cheap on I/O.
+ *
+ * The returned pointers stay valid until the reader is closed or destroyed.
+ */
+class FrameRecordingReader {
+public:
+    /**
+     * One recorded frame.
+     */
+    struct Frame {
+        FrameRole role;
+
+        int frameNumber;
+
+        /**
+         * The NV21 frame, inside the mapped recording.
+         */
+        const uint8_t *data;
+
+        size_t byteCount;
+    };
+
+    /**
+     * Creates a reader with no open recording.
+     * @return a FrameRecordingReader
+     */
+    FrameRecordingReader();
+
+    /**
+     * Unmaps the recording, if any.
+     */
+    ~FrameRecordingReader();
+
+    FrameRecordingReader(const FrameRecordingReader &) = delete;
+
+    FrameRecordingReader &operator=(const FrameRecordingReader &) = delete;
+
+    /**
+     * Maps the recording in memory & validates its header & index. Closes the previous recording first, if one is open.
+     *
+     * @param [in] path location of the recording file
+     * @param [out] error description of the problem, if any
+     * @return false if the file can't be mapped, or isn't a complete recording
+     */
+    bool open(const std::string &path, std::string &error);
+
+    /**
+     * Unmaps the recording. Every pointer returned so far becomes invalid.
+     */
+    void close();
+
+    /**
+     * @return number of frames in the recording, 0 if none is open
+     */
+    int getFrameCount() const;
+
+    /**
+     * @param [in] frameIndex position of the frame in the recording, smaller than FrameRecordingReader::getFrameCount()
+     * @return the frame
+     */
+    Frame getFrame(const int frameIndex) const;
+
+    /**
+     * @param [in] role the FrameRole whose properties are needed
+     * @return the ImageProperties of the frames with the given role, as given to FrameRecordingWriter::open()
+     */
+    ImageProperties getImageProperties(const FrameRole role) const;
+
+private:
+    const uint8_t *mapping;
+
+    size_t mappingByteCount;
+
+    const FrameRecordingHeader *header;
+
+    const FrameRecordingIndexEntry *index;
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_FRAMERECORDINGREADER_HPP
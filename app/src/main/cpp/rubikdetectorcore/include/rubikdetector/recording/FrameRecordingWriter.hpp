@@ -0,0 +1,99 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_FRAMERECORDINGWRITER_HPP
+#define RUBIKDETECTOR_FRAMERECORDINGWRITER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FrameRole.hpp"
+#include "internal/FrameRecordingFormat.hpp"
+
+namespace rbdt {
+
+class ImageProperties;
+
+/**
+ * Writes NV21 frames, back to back, into a single recording file which can later be mapped in memory & replayed through a
+ * FrameRecordingReader, without decoding or copying the frames.
+ *
+ * The recording stores the scan & photo ImageProperties once, in its header, so every frame of a given FrameRole needs to have
+ * the size described by them. The index of the frames is kept in memory & written when the recording is finished, so a recording
+ * is only readable after FrameRecordingWriter::finish() was called, or the writer was destroyed.
+ *
+ * This class is <b>not</b> thread safe.
+ */
+class FrameRecordingWriter {
+public:
+    /**
+     * Creates a writer with no open recording.
+     * @return a FrameRecordingWriter
+     */
+    FrameRecordingWriter();
+
+    /**
+     * Finishes the open recording, if any.
+     */
+    ~FrameRecordingWriter();
+
+    FrameRecordingWriter(const FrameRecordingWriter &) = delete;
+
+    FrameRecordingWriter &operator=(const FrameRecordingWriter &) = delete;
+
+    /**
+     * Creates, or truncates, the recording file. Finishes the previous recording first, if one is open.
+     *
+     * @param [in] path location of the recording file, where write access is granted
+     * @param [in] scanProperties properties of the frames appended as FrameRole::SCAN
+     * @param [in] photoProperties properties of the frames appended as FrameRole::PHOTO
+     * @return false if the file can't be created
+     */
+    bool open(const std::string &path, const ImageProperties &scanProperties, const ImageProperties &photoProperties);
+
+    /**
+     * Appends a NV21 frame to the recording.
+     *
+     * @param [in] role the FrameRole of the frame, which also decides its expected size
+     * @param [in] frameNumber number identifying the frame, stored in the index as is
+     * @param [in] data the NV21 frame
+     * @return false if no recording is open or the write failed. A failed write closes the recording.
+     */
+    bool append(const FrameRole role, const int frameNumber, const uint8_t *data);
+
+    /**
+     * Writes the index & the final header, then closes the file. Does nothing if no recording is open.
+     *
+     * @return false if the index or the header could not be written
+     */
+    bool finish();
+
+    /**
+     * @return true if a recording is open
+     */
+    bool isOpen() const;
+
+private:
+    bool writeAt(const uint64_t offset, const void *data, const size_t byteCount);
+
+    void close();
+
+    int fileDescriptor;
+
+    uint64_t scanFrameByteCount;
+
+    uint64_t photoFrameByteCount;
+
+    /**
+     * Offset at which the next frame will be written. Always a multiple of FRAME_RECORDING_ALIGNMENT.
+     */
+    uint64_t nextFrameOffset;
+
+    FrameRecordingHeader header;
+
+    std::vector<FrameRecordingIndexEntry> index;
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_FRAMERECORDINGWRITER_HPP
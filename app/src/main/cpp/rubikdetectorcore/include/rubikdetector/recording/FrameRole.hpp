@@ -0,0 +1,21 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_FRAMEROLE_HPP
+#define RUBIKDETECTOR_FRAMEROLE_HPP
+
+#include <cstdint>
+
+namespace rbdt {
+
+/**
+ * Role of a recorded frame, i.e. whether it was passed to RubikProcessor::processScan() or to RubikProcessor::processPhoto().
+ */
+enum class FrameRole : uint32_t {
+    SCAN = 0,
+    PHOTO = 1
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_FRAMEROLE_HPP
@@ -0,0 +1,81 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_FRAMERECORDINGFORMAT_HPP
+#define RUBIKDETECTOR_FRAMERECORDINGFORMAT_HPP
+
+#include <cstdint>
+
+namespace rbdt {
+
+    /**
+     * Identifies a recording file.
+     */
+    static constexpr char FRAME_RECORDING_MAGIC[8] = {'R', 'B', 'D', 'T', 'R', 'E', 'C', '\0'};
+
+    static constexpr uint32_t FRAME_RECORDING_VERSION = 1;
+
+    /**
+     * Alignment, in bytes, of every frame within the recording.
+     */
+    static constexpr uint64_t FRAME_RECORDING_ALIGNMENT = 64;
+
+/**
+ * On disk layout of a frame recording, shared by the FrameRecordingWriter & the FrameRecordingReader. All the fields are stored in
+ * the native byte order.
+ *
+ * A recording is laid out as follows:
+ * <pre>
+ * FrameRecordingHeader | frame 0 | padding | frame 1 | padding | ... | FrameRecordingIndexEntry[frameCount]
+ * </pre>
+ *
+ * Every frame starts at a multiple of FRAME_RECORDING_ALIGNMENT, so it can be used in place once the file is mapped. The index is
+ * written after the last frame when the recording is finished, which also fills in FrameRecordingHeader::indexOffset. A recording
+ * with an index offset of 0 was not finished, and is rejected by the reader.
+ *
+ * @warning Only meant to be used by the FrameRecordingWriter & the FrameRecordingReader.
+ */
+    struct FrameRecordingHeader {
+        char magic[8];
+
+        uint32_t version;
+
+        uint32_t frameCount;
+
+        int32_t scanWidth;
+
+        int32_t scanHeight;
+
+        int32_t scanRotation;
+
+        int32_t photoWidth;
+
+        int32_t photoHeight;
+
+        int32_t photoRotation;
+
+        uint64_t indexOffset;
+
+        uint8_t reserved[16];
+    };
+
+    struct FrameRecordingIndexEntry {
+        /**
+         * One of the FrameRole values.
+         */
+        uint32_t role;
+
+        int32_t frameNumber;
+
+        uint64_t offset;
+
+        uint64_t byteCount;
+    };
+
+    static_assert(sizeof(FrameRecordingHeader) == FRAME_RECORDING_ALIGNMENT, "the first frame needs to start right after the header");
+
+    static_assert(sizeof(FrameRecordingIndexEntry) == 24, "unexpected padding in FrameRecordingIndexEntry");
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_FRAMERECORDINGFORMAT_HPP
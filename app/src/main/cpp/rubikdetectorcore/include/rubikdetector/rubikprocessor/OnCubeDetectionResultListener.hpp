@@ -0,0 +1,36 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_ONCUBEDETECTIONRESULTLISTENER_HPP
+#define RUBIKDETECTOR_ONCUBEDETECTIONRESULTLISTENER_HPP
+
+#include <cstdint>
+
+namespace rbdt {
+
+/**
+ * Receives the results of the scan frames submitted through RubikProcessor::submitScan().
+ *
+ * Results are delivered in submission order, on a thread owned by the RubikProcessor. Implementations should return quickly,
+ * since the next frame cannot be delivered until this call returns. Exceptions thrown from the callback are logged & ignored.
+ */
+class OnCubeDetectionResultListener {
+public:
+    /**
+     * Empty virtual destructor.
+     */
+    virtual ~OnCubeDetectionResultListener() {}
+
+    /**
+     * Called once for every frame accepted by RubikProcessor::submitScan().
+     *
+     * @param [in] scanData the same pointer that was passed to RubikProcessor::submitScan(). The processor no longer uses it after this call.
+     * @param [in] frameNumber the number the processor assigned to the frame
+     * @param [in] cubeFound true if the three faces of the cube were detected in the frame
+     */
+    virtual void onCubeDetectionResult(const uint8_t *scanData, int frameNumber, bool cubeFound) = 0;
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_ONCUBEDETECTIONRESULTLISTENER_HPP
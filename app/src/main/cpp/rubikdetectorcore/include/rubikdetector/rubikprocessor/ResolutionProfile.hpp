@@ -0,0 +1,34 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_RESOLUTIONPROFILE_HPP
+#define RUBIKDETECTOR_RESOLUTIONPROFILE_HPP
+
+namespace rbdt {
+
+/**
+ * Resolution at which a RubikProcessor searches for the cube, set through RubikProcessorBuilder::resolutionProfile() or
+ * RubikProcessor::setResolutionProfile().
+ *
+ * Each profile gives the size of the square processing frame and of the three face images extracted from it. The buffer layout & the
+ * pixel sizes used by the RubikFaceletsDetector follow the profile. Lower resolutions trade some accuracy, mostly on small or far away
+ * cubes, for a higher frame rate.
+ */
+enum class ResolutionProfile {
+    /**
+     * 240x240 processing frame, 180x180 faces. Meant for low end devices.
+     */
+    FAST,
+    /**
+     * 480x480 processing frame, 360x360 faces.
+     */
+    DEFAULT,
+    /**
+     * 720x720 processing frame, 540x540 faces.
+     */
+    PRECISE
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_RESOLUTIONPROFILE_HPP
@@ -8,7 +8,13 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include "../data/processing/RubikFacelet.hpp"
+#include "../data/processing/FaceGrid.hpp"
+#include "../data/processing/ImagePatches.hpp"
+#include "../data/metrics/StageLatency.hpp"
+#include "ScanOutcome.hpp"
+#include "ResolutionProfile.hpp"
 #include "../processing_templates/ImageProcessor.hpp"
 #include "../detectors/colordetector/RubikColorDetector.hpp"
 #include "../detectors/faceletsdetector/RubikFaceletsDetector.hpp"
@@ -38,8 +44,8 @@ class ImageProperties;
  *  -# Delegates the drawing of the found facelets to a FaceletsDrawController.
  *  -# Prints debug info & saves debug images through a ImageSaver, if debuggable mode is active.
  *
- * This class expects input data to be provided as a <i>const uint8_t *</i> array, and will return a 2D std::vector
- * of RubikFacelet objects, if the Rubik's Cube is detected within the processed frame.
+ * This class expects input data to be provided as a <i>const uint8_t *</i> array, and will return a FaceGrid
+ * for each face, if the Rubik's Cube is detected within the processed frame.
  *
  * Additionally, it expects the image properties passed to RubikProcessor::updateImageProperties() to be of type ImageProperties.
  *
@@ -51,6 +57,10 @@ class ImageProperties;
  *   - the current DrawConfig, through RubikProcessor::updateDrawConfig();
  *   - the debuggable state, through RubikProcessor::setDebuggable().
  *
+ * Scan frames can also be processed asynchronously through RubikProcessor::submitScan(). In that case the results are delivered to an
+ * OnCubeDetectionResultListener, in submission order, from a thread owned by the processor. RubikProcessor::updateImageProperties() waits
+ * for the frames already submitted before applying the new properties.
+ *
  * This class is <b>not</b> thread safe. If used from multiple threads, the only hard requirement is to make sure RubikProcessor::process() is
  * not called for obsolete ImageProperties. In other words, always make sure no thread calls RubikProcessor::process() before
  * RubikProcessor::updateImageProperties() is called, after a change in input image size or format.
@@ -64,7 +74,7 @@ class ImageProperties;
  * @see ImageProcessor
  */
 class RubikProcessor
-        : public ImageProcessor<const uint8_t *, const ImageProperties &, std::vector<std::vector<RubikFacelet>>> {
+        : public ImageProcessor<const uint8_t *, const ImageProperties &, FaceGrid> {
 
 public:
 
@@ -75,10 +85,135 @@ public:
 
     bool processScan(const uint8_t *scanData) override;
 
+    /**
+     * Same as RubikProcessor::processScan(), but also tells why the cube was not found.
+     *
+     * @param [in] scanData the scan frame, laid out as for RubikProcessor::processScan()
+     * @return ScanOutcome::CUBE_FOUND if the cube was found, otherwise the reason it wasn't
+     */
+    ScanOutcome processScanWithOutcome(const uint8_t *scanData);
+
     bool processPhoto(const uint8_t *scanData, const uint8_t *photoData) override;
 
     CubeState processColors(const uint8_t *imageData) override;
 
+    /**
+     * Asynchronous counterpart of RubikProcessor::processScan().
+     *
+     * The frame is handed to an internal two stage pipeline (preprocessing, then facelets detection) and this method returns
+     * immediately. The result is delivered to the OnCubeDetectionResultListener set through RubikProcessor::setOnCubeDetectionResultListener().
+     *
+     * The pipeline is bounded: when it is full the frame is rejected, which is the expected behavior for a camera preview that can simply
+     * skip frames. Unlike with RubikProcessor::processScan(), the face images are not written back into <b>scanData</b>.
+     *
+     * @param [in] scanData the scan frame, laid out as for RubikProcessor::processScan(). It has to stay valid & unmodified until the
+     * listener is notified about it.
+     * @return true if the frame was accepted, false if it was dropped because the pipeline is full
+     */
+    bool submitScan(const uint8_t *scanData);
+
+    /**
+     * Blocks until the results of all the frames accepted by RubikProcessor::submitScan() have been delivered.
+     */
+    void flushScans();
+
+    /**
+     * Sets the listener which receives the results of RubikProcessor::submitScan(). Passing nullptr discards the results.
+     *
+     * @param [in] listener the OnCubeDetectionResultListener
+     */
+    void setOnCubeDetectionResultListener(std::shared_ptr<OnCubeDetectionResultListener> listener);
+
+    /**
+     * Returns the latency statistics of each ProcessingStage, recorded with a monotonic clock since the library was loaded or since
+     * the last call to RubikProcessor::resetStageLatencies(). The statistics are process wide: every RubikProcessor records into them.
+     *
+     * @return one StageLatency per ProcessingStage, in the ProcessingStage declaration order
+     */
+    static std::vector<StageLatency> getStageLatencies();
+
+    /**
+     * Discards the latencies recorded so far, by every RubikProcessor.
+     */
+    static void resetStageLatencies();
+
+    /**
+     * Writes the log messages retained by the library to the platform logger. Only has an effect when the messages are buffered,
+     * see RBDT_LOG_BUFFERED in CrossLog.hpp. The buffer is shared by all the RubikProcessor instances.
+     */
+    void flushLogs();
+
+    /**
+     * Starts recording every frame passed to RubikProcessor::processScan(), RubikProcessor::submitScan() & RubikProcessor::processPhoto()
+     * into a single file, which can be replayed later through a FrameRecordingReader. A recording already in progress is finished first.
+     *
+     * The frames are written on the calling thread, so recording slows the processing down. Changing the scan properties through
+     * RubikProcessor::updateImageProperties() finishes the recording, since a recording only holds frames of one size per FrameRole.
+     *
+     * @param [in] path location of the recording file, where write access is granted
+     * @return false if the recording file can't be created
+     */
+    bool startRecording(const std::string &path);
+
+    /**
+     * Finishes the recording in progress, if any. The recording can only be read once it was finished, either by this method or by
+     * destroying the processor.
+     */
+    void stopRecording();
+
+    /**
+     * Enables or disables the early exit of the scan detection. Enabled by default.
+     *
+     * A scan frame is only accepted if all three visible faces are found. When enabled, the processor first samples & detects the face
+     * which failed most often in the recent frames, and rejects the frame right away if it is not found, without sampling or detecting
+     * the two other faces. Since most preview frames don't show the cube, this saves most of the work done while nothing happens.
+     * Once the cube was found in the previous frame, or while the faces are rarely missed, the three faces are detected in parallel
+     * instead, so the frames showing the cube don't pay for the screen with a higher latency.
+     *
+     * Applies to both RubikProcessor::processScan() & RubikProcessor::submitScan().
+     *
+     * @param [in] enabled false to always detect the three faces in parallel
+     */
+    void setScanCascadeEnabled(bool enabled);
+
+    /**
+     * Enables or disables the scan gate. Enabled by default.
+     *
+     * When enabled, RubikProcessor::processScan() first measures the sharpness of the frame & how much it changed since the last frame
+     * in which the cube was not found, on a heavily downscaled copy of its luminance. Blurry frames, which are common while the cube is
+     * being repositioned, and frames nearly identical to the last failed one skip the detection altogether. A few frames in a row at
+     * most are skipped, so the detection keeps running even if the gate misjudges the frames.
+     *
+     * RubikProcessor::processScanWithOutcome() tells the skipped frames apart. RubikProcessor::submitScan() always processes the frames.
+     *
+     * @param [in] enabled false to run the detection on every scan frame
+     */
+    void setScanGateEnabled(bool enabled);
+
+    /**
+     * Changes the resolution at which the cube is searched for. The initial profile is set through RubikProcessorBuilder::resolutionProfile().
+     *
+     * Like RubikProcessor::updateImageProperties(), this changes the buffer layout: RubikProcessor::getRequiredMemory() & the offsets
+     * need to be queried again before the next frame. The frames accepted by RubikProcessor::submitScan() are flushed first. The facelets
+     * saved by RubikProcessor::processPhoto() are placed according to the layout, so the profile shouldn't change between the two
+     * scan phases. Does nothing if the profile is already in use.
+     *
+     * @param [in] profile the ResolutionProfile to use from the next frame on
+     */
+    void setResolutionProfile(const ResolutionProfile profile);
+
+    /**
+     * View over the 54 facelets saved in the shared buffer by RubikProcessor::processPhoto(), in the order used by CubeState. Each
+     * facelet is a small BGR image, and they follow each other in the buffer.
+     *
+     * The view follows the current buffer layout, so it needs to be queried again after RubikProcessor::updateImageProperties() or
+     * RubikProcessor::setResolutionProfile().
+     *
+     * @param [in] data the shared buffer passed to RubikProcessor::processPhoto()
+     * @return the facelets, which can be passed to RubikColorDetector::detectColors() as a whole
+     */
+    ImagePatches getFaceletPatches(uint8_t *data);
+
     void updateScanPhase(const bool &isSecondPhase) override;
 
     void updateImageProperties(const ImageProperties &imageProperties) override;
@@ -98,6 +233,7 @@ private:
 
     RubikProcessor(const ImageProperties scanProperties,
                    const ImageProperties photoProperties,
+                   const ResolutionProfile resolutionProfile,
                    std::unique_ptr<RubikFaceletsDetector> faceletsDetector,
                    std::unique_ptr<RubikColorDetector> colorDetector,
                    std::shared_ptr<ImageSaver> imageSaver);
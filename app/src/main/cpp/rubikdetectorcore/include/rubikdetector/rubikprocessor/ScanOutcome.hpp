@@ -0,0 +1,34 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_SCANOUTCOME_HPP
+#define RUBIKDETECTOR_SCANOUTCOME_HPP
+
+namespace rbdt {
+
+/**
+ * Result of RubikProcessor::processScanWithOutcome(). Tells apart the frames in which the cube was searched for from those which
+ * were skipped by the scan gate, and why.
+ */
+enum class ScanOutcome {
+    /**
+     * The three faces of the cube were found.
+     */
+    CUBE_FOUND,
+    /**
+     * The frame was processed, but the cube was not found.
+     */
+    CUBE_NOT_FOUND,
+    /**
+     * Skipped, the frame is too blurry for the facelets to be detected, usually because the camera or the cube are moving.
+     */
+    SKIPPED_BLURRY,
+    /**
+     * Skipped, the frame is nearly identical to the last frame in which the cube was not found.
+     */
+    SKIPPED_UNCHANGED
+};
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_SCANOUTCOME_HPP
@@ -28,6 +28,7 @@ namespace rbdt {
  *   - RubikFaceletsDetector: an instance of a SimpleFaceletsDetector
  *   - RubikColorDetector: an instance of a HistogramColorDetector
  *   - ImageSaver: nullptr
+ *   - ResolutionProfile: ResolutionProfile::DEFAULT
  *   - debuggable: false
  *
  * See various methods customizing the properties before building the desired RubikProcessor.
@@ -45,6 +46,7 @@ namespace rbdt {
          *   - RubikFaceletsDetector: an instance of a SimpleFaceletsDetector
          *   - RubikColorDetector: an instance of a HistogramColorDetector
          *   - ImageSaver: nullptr
+         *   - ResolutionProfile: ResolutionProfile::DEFAULT
          *   - debuggable: false
          *
          * @return a RubikProcessorBuilder
@@ -59,6 +61,15 @@ namespace rbdt {
 
         RubikProcessorBuilder &photoSize(int width, int height);
 
+        /**
+         * Specifies the resolution at which the RubikProcessor searches for the cube. Can be changed later through
+         * RubikProcessor::setResolutionProfile(). ResolutionProfile::DEFAULT is used if not set.
+         *
+         * @param [in] profile the ResolutionProfile to be used.
+         * @return the same RubikProcessorBuilder instance
+         */
+        RubikProcessorBuilder &resolutionProfile(ResolutionProfile profile);
+
         /**
          * Specifies the RubikColorDetector used by the RubikProcessor when detecting color.
          *
@@ -124,6 +135,8 @@ namespace rbdt {
 
         int mPhotoHeight;
 
+        ResolutionProfile mResolutionProfile;
+
         std::unique_ptr<RubikColorDetector> mColorDetector;
 
         std::unique_ptr<RubikFaceletsDetector> mFaceletsDetector;
@@ -0,0 +1,121 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_COLORASSIGNMENT_HPP
+#define RUBIKDETECTOR_COLORASSIGNMENT_HPP
+
+#include <array>
+#include <opencv2/core/core.hpp>
+#include "../../data/processing/CubeState.h"
+#include "../../utils/CIEDE2000Batch.hpp"
+
+namespace rbdt {
+
+/**
+ * Assigns each of the 54 facelets of the cube to one of the 6 faces, from the mean color of every facelet, used by
+ * RubikProcessorImpl::processColors().
+ *
+ * A solved cube has exactly 9 facelets of each color, and the center facelets never move. These are hard constraints here: each center
+ * is assigned to its own face, and the 48 remaining facelets are split 8 per face by a minimum cost assignment, solved exactly with the
+ * Hungarian method. The cost of giving a facelet to a face is the CIEDE2000 difference between their colors, all computed at once by
+ * computeCIEDE2000Matrix().
+ *
+ * The color of a face starts as the color of its center. After each assignment it is replaced by the mean color of the 9 facelets
+ * given to the face, and the assignment is solved again, for at most ColorAssignment::MAX_ROUNDS rounds. There is no random
+ * initialization and the amount of work is bounded, so the same colors always give the same result in about the same time.
+ *
+ * The buffers are kept between calls, so solving does not allocate once warmed up.
+ *
+ * @warning Do not use ColorAssignment directly, do not expose this in the API. Use RubikProcessor::processColors() instead.
+ */
+class ColorAssignment {
+public:
+    /**
+     * @param [in] faceletColors mean color of each facelet, in CIELAB. The facelets are ordered by face, in the CubeState::Face order,
+     * and in row major order within each face.
+     * @param [out] faces receives the face each facelet was assigned to
+     * @param [out] faceColors receives the color of each face in OpenCV's 8 bit Lab encoding, in the CubeState::Face order
+     */
+    void solve(const std::array<cv::Vec3f, CubeState::FACELET_COUNT> &faceletColors,
+               std::array<CubeState::Face, CubeState::FACELET_COUNT> &faces,
+               std::array<cv::Scalar, CubeState::FACE_COUNT> &faceColors);
+
+private:
+    static constexpr int FACELETS_PER_FACE = CubeState::FACELET_COUNT / CubeState::FACE_COUNT;
+
+    /**
+     * Position of the center within the 9 facelets of a face.
+     */
+    static constexpr int CENTER_INDEX = FACELETS_PER_FACE / 2;
+
+    /**
+     * Facelets which aren't centers. Each face receives FACELETS_PER_FACE - 1 of them.
+     */
+    static constexpr int FREE_FACELET_COUNT = CubeState::FACELET_COUNT - CubeState::FACE_COUNT;
+
+    static constexpr int MAX_ROUNDS = 4;
+
+    /**
+     * Converts from CIELAB to OpenCV's 8 bit Lab encoding, without rounding.
+     */
+    static cv::Scalar toEncodedLab(float l, float a, float b);
+
+    /**
+     * Fills ColorAssignment::costs from the current face colors.
+     */
+    void computeCosts();
+
+    /**
+     * Solves the assignment of the free facelets to the face slots with the Hungarian method, in O(FREE_FACELET_COUNT^3).
+     *
+     * @param [out] assignedFaces receives the face of each free facelet
+     */
+    void assign(std::array<int, FREE_FACELET_COUNT> &assignedFaces);
+
+    /**
+     * Positions, among the 54 facelets, of the free facelets.
+     */
+    std::array<int, FREE_FACELET_COUNT> freeFacelets;
+
+    /**
+     * CIELAB colors of the free facelets, one array per channel.
+     */
+    std::array<float, FREE_FACELET_COUNT> freeL;
+
+    std::array<float, FREE_FACELET_COUNT> freeA;
+
+    std::array<float, FREE_FACELET_COUNT> freeB;
+
+    /**
+     * Current CIELAB colors of the faces, one array per channel.
+     */
+    std::array<float, CubeState::FACE_COUNT> faceL;
+
+    std::array<float, CubeState::FACE_COUNT> faceA;
+
+    std::array<float, CubeState::FACE_COUNT> faceB;
+
+    /**
+     * Cost of giving each free facelet to each face, CubeState::FACE_COUNT rows of FREE_FACELET_COUNT values.
+     */
+    std::array<float, CubeState::FACE_COUNT * FREE_FACELET_COUNT> costs;
+
+    /**
+     * Potentials & augmenting path bookkeeping of the Hungarian method, indexed from 1 with 0 as the sentinel.
+     */
+    std::array<double, FREE_FACELET_COUNT + 1> rowPotentials;
+
+    std::array<double, FREE_FACELET_COUNT + 1> slotPotentials;
+
+    std::array<double, FREE_FACELET_COUNT + 1> minSlack;
+
+    std::array<int, FREE_FACELET_COUNT + 1> slotRows;
+
+    std::array<int, FREE_FACELET_COUNT + 1> previousSlots;
+
+    std::array<bool, FREE_FACELET_COUNT + 1> visitedSlots;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_COLORASSIGNMENT_HPP
@@ -0,0 +1,86 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_LABLOOKUPTABLE_HPP
+#define RUBIKDETECTOR_LABLOOKUPTABLE_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+namespace rbdt {
+
+/**
+ * Largest CIEDE2000 distance between the color returned by LabLookupTable::convert() & the one computed by OpenCV's float
+ * cv::COLOR_BGR2Lab for the same 8 bit BGR color.
+ */
+constexpr float LAB_LOOKUP_TABLE_MAX_ERROR = 0.5f;
+
+/**
+ * Converts 8 bit BGR colors to CIELAB through a precomputed table, used by RubikProcessorImpl to compute the colors of the facelets.
+ *
+ * The table holds the CIELAB color of GRID_SIZE^3 BGR colors evenly spread over the BGR cube, converted once by OpenCV's float
+ * cv::COLOR_BGR2Lab when the table is created. Any other color is interpolated trilinearly between the 8 nodes around it, so a
+ * conversion costs a few table reads & multiplications instead of the gamma expansion & cube roots of the exact conversion.
+ *
+ * The table is read only once built, so it can be shared between threads.
+ *
+ * @warning Do not use LabLookupTable directly, do not expose this in the API. Use RubikProcessor::processColors() instead.
+ */
+class LabLookupTable {
+public:
+    /**
+     * Nodes per channel. The 8 bit range is split in GRID_SIZE - 1 cells of 8 levels each, small enough for the interpolation to
+     * stay well below a perceptible difference.
+     */
+    static constexpr int GRID_SIZE = 33;
+
+    /**
+     * Builds the table, about 35k conversions.
+     */
+    LabLookupTable();
+
+    /**
+     * @return the CIELAB color of the 8 bit BGR color, L in [0, 100] and a, b roughly in [-128, 127]
+     */
+    cv::Vec3f convert(uint8_t blue, uint8_t green, uint8_t red) const;
+
+    /**
+     * Mean CIELAB color of contiguous 8 bit BGR pixels. Each pixel is converted before averaging.
+     *
+     * @param [in] pixels <b>pixelCount</b> BGR pixels, 3 bytes each
+     * @param [in] pixelCount at least 1
+     */
+    cv::Vec3f mean(const uint8_t *pixels, int pixelCount) const;
+
+private:
+    static constexpr int CHANNELS = 3;
+
+    static constexpr int GREEN_STRIDE = GRID_SIZE * CHANNELS;
+
+    static constexpr int BLUE_STRIDE = GRID_SIZE * GREEN_STRIDE;
+
+    /**
+     * Adds the CIELAB color of the BGR color to <b>lab</b>.
+     */
+    void accumulate(uint8_t blue, uint8_t green, uint8_t red, float *lab) const;
+
+    /**
+     * CIELAB color of every node, L a b interleaved. The node of the BGR grid position (b, g, r) starts at
+     * b * BLUE_STRIDE + g * GREEN_STRIDE + r * CHANNELS.
+     */
+    std::vector<float> nodes;
+
+    /**
+     * Grid position of the node below each 8 bit level, and offset of the level from that node, in [0, 1]. Saves the division
+     * of every lookup.
+     */
+    std::array<int, 256> cellIndices;
+
+    std::array<float, 256> cellWeights;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_LABLOOKUPTABLE_HPP
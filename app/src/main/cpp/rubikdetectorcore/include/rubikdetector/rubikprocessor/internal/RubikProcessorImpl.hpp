@@ -13,10 +13,22 @@
 #include "../../data/processing/internal/HueColorEvidence.hpp"
 #include "../../imagesaver/ImageSaver.hpp"
 #include "../../rubikprocessor/RubikProcessor.hpp"
+#include "../../rubikprocessor/ResolutionProfile.hpp"
 #include "../../data/config/ImageProperties.hpp"
 #include "../../data/processing/CubeState.h"
+#include "../../utils/WorkerPool.hpp"
+#include "../../recording/FrameRecordingWriter.hpp"
+#include "ColorAssignment.hpp"
+#include "LabLookupTable.hpp"
+#include "ScanGate.hpp"
+#include "ScanPipeline.hpp"
+#include <array>
+#include <atomic>
+#include <exception>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace rbdt {
     class OnCubeDetectionResultListener;
@@ -62,16 +74,38 @@ namespace rbdt {
  * @see RubikProcessor
  */
     class RubikProcessorImpl
-            : public ImageProcessor<const uint8_t *, const ImageProperties &, std::vector<std::vector<RubikFacelet>>> {
+            : public ImageProcessor<const uint8_t *, const ImageProperties &, FaceGrid> {
     public:
         virtual ~RubikProcessorImpl();
 
         bool processScan(const uint8_t *scanData) override;
 
+        ScanOutcome processScanWithOutcome(const uint8_t *scanData);
+
         bool processPhoto(const uint8_t *scanData, const uint8_t *photoData) override;
 
         CubeState processColors(const uint8_t *imageData) override;
 
+        bool submitScan(const uint8_t *scanData);
+
+        void flushScans();
+
+        void setOnCubeDetectionResultListener(std::shared_ptr<OnCubeDetectionResultListener> listener);
+
+        void flushLogs();
+
+        bool startRecording(const std::string &path);
+
+        void stopRecording();
+
+        void setScanCascadeEnabled(bool enabled);
+
+        void setScanGateEnabled(bool enabled);
+
+        void setResolutionProfile(const ResolutionProfile profile);
+
+        ImagePatches getFaceletPatches(uint8_t *data);
+
         void updateScanPhase(const bool &isSecondPhase) override;
 
         void updateImageProperties(const ImageProperties &imageProperties) override;
@@ -89,47 +123,221 @@ namespace rbdt {
     private:
         friend class RubikProcessor;
 
+        /**
+         * Detection of one face, in the top, left, right order. Lives on the stack of the call fanning the faces out to the
+         * RubikProcessorImpl::detectionPool, which waits on the TaskLatch before returning, so the fan-out doesn't allocate.
+         */
+        struct FaceDetectionTask : public PooledTask {
+            FaceDetectionTask(RubikFaceletsDetector &detector, cv::Mat &face, const int faceIndex, const int frameNr,
+                              const bool tracking, TaskLatch &latch);
+
+            /**
+             * Detects the face on the calling thread.
+             */
+            FaceGrid detect();
+
+            /**
+             * Detects the face into FaceDetectionTask::grid, or stores the exception in FaceDetectionTask::error, then counts the
+             * latch down.
+             */
+            void run() override;
+
+            RubikFaceletsDetector &detector;
+
+            cv::Mat &face;
+
+            const int faceIndex;
+
+            const int frameNr;
+
+            const bool tracking;
+
+            TaskLatch &latch;
+
+            FaceGrid grid;
+
+            std::exception_ptr error;
+        };
+
         RubikProcessorImpl(const ImageProperties scanProperties,
                            const ImageProperties photoProperties,
+                           const ResolutionProfile resolutionProfile,
                            std::unique_ptr<RubikFaceletsDetector> faceletsDetector,
                            std::unique_ptr<RubikColorDetector> colorDetector,
                            std::shared_ptr<ImageSaver> imageSaver);
 
         bool scanCubeInternal(const uint8_t *scanData);
 
+        /**
+         * First stage of the scan processing. Samples the three faces, one after the other, into <b>facesData</b> directly from the
+         * Y plane of the NV21 scan frame, using the maps built by buildScanFaceMaps().
+         */
+        void prepareScanFaces(const uint8_t *scanData, uint8_t *facesData);
+
+        /**
+         * Samples one face, in the top, left, right order, into its place in <b>facesData</b>.
+         */
+        void warpScanFace(const int face, const uint8_t *scanData, uint8_t *facesData);
+
+        /**
+         * Second stage of the scan processing. Searches for the cube in the three faces written by prepareScanFaces().
+         *
+         * @return true if all three faces were detected
+         */
+        bool detectScanFaces(uint8_t *facesData, int frameNr);
+
+        /**
+         * Detects the face most likely to fail first, according to RubikProcessorImpl::faceFailureRates, and stops there if it is
+         * not found. Otherwise the two remaining faces are detected in parallel.
+         *
+         * The serial screen only pays off while the cube is out of view. When the previous scan frame found the cube, or when every
+         * face failed less than RubikProcessorImpl::CASCADE_FAILURE_RATE in the recent frames, the three faces are detected in
+         * parallel right away.
+         *
+         * @param [in] scanData the scan frame, from which each face is sampled right before its detection. nullptr if the faces
+         * were already sampled into <b>facesData</b>.
+         * @return true if all three faces were detected
+         */
+        bool detectScanFacesCascade(const uint8_t *scanData, uint8_t *facesData, int frameNr);
+
+        void updateFaceFailureRate(const int face, const bool found);
+
         bool extractFaceletsInternal(const uint8_t *scanData, const uint8_t *photoData);
 
         CubeState analyzeColorsInternal(const uint8_t *data);
 
+        /**
+         * Fills RubikProcessorImpl::faceletColors from the 54 facelets saved in <b>data</b>, in a single pass over them. Each pixel is
+         * converted to CIELAB through RubikProcessorImpl::labLookupTable before averaging.
+         */
+        void computeFaceletColors(const uint8_t *data);
+
+        /**
+         * Runs the RubikFaceletsDetector on the three faces concurrently. Two of the faces are handed to the
+         * RubikProcessorImpl::detectionPool while the calling thread detects the remaining one. Each face is written to its own
+         * output parameter.
+         *
+         * @param [in] tracking false for the photos, which get the full detection through RubikFaceletsDetector::detectUntracked() &
+         * leave the tracking state of the scan frames alone
+         * @return true if all three faces were found
+         */
+        bool detectFaces(cv::Mat &topFace, cv::Mat &leftFace, cv::Mat &rightFace, const int frameNr, const bool tracking,
+                         FaceGrid &topGrid, FaceGrid &leftGrid, FaceGrid &rightGrid);
+
         void rotateMat(cv::Mat &matImage, int rotFlag);
 
-        void cropResizeAndRotate(cv::Mat &matImage, bool needsCrop, const cv::Rect& croppingRegion,
-                                 int frameDimension, bool needsResize, int rotation);
+        /**
+         * Scales a region of one of the photo planes to the processing size. <b>destination</b> needs to be allocated with the
+         * expected size, since it usually points into a bigger image.
+         */
+        void resizePhotoRegion(const cv::Mat &source, cv::Mat &destination);
+
+        /**
+         * Maps a point of the rotated processing frame back to the processing frame before the rotation.
+         */
+        void undoRotation(float &x, float &y, int rotation) const;
+
+        /**
+         * Computes RubikProcessorImpl::photoFacesRegion & RubikProcessorImpl::photoSourceRegion. Needs to be called every
+         * time the photo ImageProperties change.
+         */
+        void computePhotoRegions();
 
         void extractFaces(cv::Mat &matImage, cv::Mat &topFace, cv::Mat &leftFace, cv::Mat &rightFace);
 
-        void applyPerspectiveTransform(const cv::Mat &inputFrame, cv::Mat &outputFrame, const std::vector<cv::Point2f> &inputPoints,
-                                       const cv::Size &outputSize);
+        /**
+         * Fills the corners, in processing frame coordinates, of the three cube faces. Each list follows the top, right, left, bottom order.
+         */
+        void computeFaceCorners(std::vector<cv::Point2f> &topFaceCorners,
+                                std::vector<cv::Point2f> &leftFaceCorners,
+                                std::vector<cv::Point2f> &rightFaceCorners) const;
+
+        /**
+         * @return the corners of an image of the given size, in the same order used by computeFaceCorners()
+         */
+        std::vector<cv::Point2f> computeOutputCorners(const cv::Size &outputSize) const;
 
-        void saveFacelets(std::vector<std::vector<RubikFacelet>> &topFacelets, cv::Mat &topFaceHSV,
-                          std::vector<std::vector<RubikFacelet>> &leftFacelets, cv::Mat &leftFaceHSV,
-                          std::vector<std::vector<RubikFacelet>> &rightFacelets, cv::Mat &rightFaceHSV,
+        /**
+         * Builds, for each face, the map from face pixels to Y plane pixels of the scan frame. The map folds the crop, resize, rotation and
+         * perspective transform into one lookup, so that prepareScanFaces() touches every face pixel only once.
+         *
+         * Needs to be called every time the scan ImageProperties change, after buildFaceHomographies().
+         */
+        void buildScanFaceMaps();
+
+        /**
+         * Computes the perspective transforms from the processing frame to each of the faces, and their inverses. Does nothing if they
+         * are already cached for the current processing dimension.
+         */
+        void buildFaceHomographies();
+
+        /**
+         * Appends the frame to the recording started through RubikProcessor::startRecording(), if any.
+         */
+        void recordFrame(const FrameRole role, const int frameNr, const uint8_t *frameData);
+
+        void saveFacelets(const FaceGrid &topGrid, cv::Mat &topFaceHSV,
+                          const FaceGrid &leftGrid, cv::Mat &leftFaceHSV,
+                          const FaceGrid &rightGrid, cv::Mat &rightFaceHSV,
                           const uint8_t *data);
 
         void applyScanPhase(const bool &isSecondPhase);
 
+        /**
+         * Sets RubikProcessorImpl::processingDimension & RubikProcessorImpl::faceDimension. The scan & photo properties need to be
+         * applied again afterwards, since the buffer layout & the cached transforms depend on these.
+         */
+        void applyResolutionProfile(const ResolutionProfile profile);
+
         void applyScanProperties(const ImageProperties &properties);
 
         void applyPhotoProperties(const ImageProperties &properties);
 
+        static constexpr int FAST_DIMENSION = 240;
+
+        static constexpr int FAST_FACE_DIMENSION = 180;
+
         static constexpr int DEFAULT_DIMENSION = 480;
 
         static constexpr int DEFAULT_FACE_DIMENSION = 360;
 
+        static constexpr int PRECISE_DIMENSION = 720;
+
+        static constexpr int PRECISE_FACE_DIMENSION = 540;
+
+        /**
+         * Same for every ResolutionProfile: the facelets are resampled from the faces anyway, and the facelets of both scan phases
+         * need to share one layout for processColors().
+         */
         static constexpr int DEFAULT_FACELET_DIMENSION = 15;
 
         static constexpr int NO_OFFSET = 0;
 
+        /**
+         * The calling thread detects one of the three faces itself, so the pool only needs one worker per remaining face.
+         */
+        static constexpr int DETECTION_WORKER_COUNT = 2;
+
+        /**
+         * Number of frames that can be held between the preprocessing & the detection stages of the ScanPipeline.
+         */
+        static constexpr int SCAN_PIPELINE_DEPTH = 2;
+
+        /**
+         * Tags passed to the RubikFaceletsDetector, in the top, left, right order.
+         */
+        static constexpr const char *FACE_TAGS[3] = {"top_face_", "left_face_", "right_face_"};
+
+        /**
+         * Weight of the latest result in RubikProcessorImpl::faceFailureRates.
+         */
+        static constexpr float FACE_FAILURE_RATE_WEIGHT = 0.125f;
+
+        /**
+         * Failure rate from which a face is screened on its own by detectScanFacesCascade(), before the other two.
+         */
+        static constexpr float CASCADE_FAILURE_RATE = 0.25f;
+
         std::unique_ptr<RubikFaceletsDetector> faceletsDetector;
 
         std::unique_ptr<RubikColorDetector> colorDetector;
@@ -143,6 +351,55 @@ namespace rbdt {
 
         bool isSecondPhase = false;
 
+        ResolutionProfile resolutionProfile;
+
+        /**
+         * Side, in pixels, of the square processing frame. Set by the RubikProcessorImpl::resolutionProfile.
+         */
+        int processingDimension;
+
+        /**
+         * Side, in pixels, of each face image passed to the RubikFaceletsDetector. Set by the RubikProcessorImpl::resolutionProfile.
+         */
+        int faceDimension;
+
+        /**
+         * If true, scan frames go through detectScanFacesCascade() & are rejected as soon as one face is not found.
+         */
+        std::atomic<bool> scanCascadeEnabled;
+
+        /**
+         * Recent rate at which each face, in the top, left, right order, was not found. Orders the faces in detectScanFacesCascade().
+         */
+        std::atomic<float> faceFailureRates[3];
+
+        /**
+         * Whether the last scan frame which went through detectScanFacesCascade() showed the cube.
+         */
+        std::atomic<bool> lastScanCubeFound;
+
+        /**
+         * If true, RubikProcessorImpl::scanGate decides which frames go through the detection in processScanWithOutcome().
+         */
+        std::atomic<bool> scanGateEnabled;
+
+        ScanGate scanGate;
+
+        /**
+         * Turns the colors of the facelets into a CubeState in analyzeColorsInternal().
+         */
+        ColorAssignment colorAssignment;
+
+        /**
+         * Built along with the processor, and never changed afterwards.
+         */
+        const LabLookupTable labLookupTable;
+
+        /**
+         * Mean color of each facelet in CIELAB, filled by computeFaceletColors().
+         */
+        std::array<cv::Vec3f, CubeState::FACELET_COUNT> faceletColors;
+
         int scanWidth;
 
         int photoWidth;
@@ -170,16 +427,6 @@ namespace rbdt {
          */
         int totalRequiredMemory;
 
-        /**
-         * @see RubikProcessor::getOutputFrameBufferOffset()
-         */
-        int frameGrayOffset;
-
-        /**
-         * @see RubikProcessor::getOutputFrameByteCount()
-         */
-        int frameGrayByteCount;
-
         /**
          * @see RubikProcessor::getInputFrameBufferOffset()
          */
@@ -213,6 +460,67 @@ namespace rbdt {
         int faceGrayByteCount;
 
         int faceletByteCount;
+
+        /**
+         * Bounding box of the three faces in the processing frame before rotation. Only this part of the photo gets processed.
+         */
+        cv::Rect photoFacesRegion;
+
+        /**
+         * RubikProcessorImpl::photoFacesRegion in full resolution photo coordinates.
+         */
+        cv::Rect photoSourceRegion;
+
+        /**
+         * Perspective transforms from the processing frame to each face, in the top, left, right order.
+         */
+        cv::Mat faceHomographies[3];
+
+        /**
+         * Inverses of RubikProcessorImpl::faceHomographies, from face pixels to processing frame pixels.
+         */
+        cv::Mat inverseFaceHomographies[3];
+
+        /**
+         * Processing dimension for which RubikProcessorImpl::faceHomographies were computed, 0 if not computed yet.
+         */
+        int faceHomographiesDimension = 0;
+
+        /**
+         * Face dimension for which RubikProcessorImpl::faceHomographies were computed, 0 if not computed yet.
+         */
+        int faceHomographiesFaceDimension = 0;
+
+        /**
+         * Fixed point maps from face pixels to scan frame pixels, one per face, in the top, left, right order. Used with cv::remap().
+         */
+        cv::Mat scanFaceMaps[3];
+
+        /**
+         * Interpolation coefficients matching RubikProcessorImpl::scanFaceMaps.
+         */
+        cv::Mat scanFaceMapsInterpolation[3];
+
+        /**
+         * Guards RubikProcessorImpl::recordingWriter, which is used both by the processing calls & by the recording controls.
+         */
+        std::mutex recordingMutex;
+
+        FrameRecordingWriter recordingWriter;
+
+        /**
+         * Persistent workers used to detect the faces in parallel. Declared last so its threads are joined
+         * before any of the components they use are destroyed.
+         */
+        WorkerPool detectionPool;
+
+        std::shared_ptr<OnCubeDetectionResultListener> resultListener;
+
+        /**
+         * Created on the first RubikProcessor::submitScan(). Declared after the RubikProcessorImpl::detectionPool since its
+         * detection stage uses the pool, so it needs to be stopped first.
+         */
+        std::unique_ptr<ScanPipeline> scanPipeline;
     };
 
 } //namespace rbdt
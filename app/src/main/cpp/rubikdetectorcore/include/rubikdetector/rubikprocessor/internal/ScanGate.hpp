@@ -0,0 +1,93 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_SCANGATE_HPP
+#define RUBIKDETECTOR_SCANGATE_HPP
+
+#include <cstdint>
+#include <opencv2/core/core.hpp>
+#include "../ScanOutcome.hpp"
+
+namespace rbdt {
+
+/**
+ * Cheap check run by the RubikProcessorImpl before the detection of a scan frame, which decides whether the detection is worth it.
+ *
+ * The luminance of the region searched for the cube is downscaled to ScanGate::GATE_DIMENSION pixels per side. On that small image:
+ *   - the variance of the Laplacian measures the sharpness. Frames below ScanGate::MIN_SHARPNESS are skipped as blurry;
+ *   - the mean absolute difference to the last frame in which the cube was not found measures the motion. Frames below
+ *   ScanGate::MIN_MOTION are skipped as unchanged, since the detection would most likely fail again.
+ *
+ * No more than ScanGate::MAX_CONSECUTIVE_SKIPS frames are skipped in a row, so a badly tuned threshold can slow the detection down
+ * but never stop it.
+ *
+ * @warning Do not use ScanGate directly, do not expose this in the API. Use RubikProcessor::setScanGateEnabled() instead.
+ */
+class ScanGate {
+public:
+    /**
+     * Sets the frame layout. Forgets the previous reference frame, since it has a different layout.
+     *
+     * @param [in] frameWidth width of the Y plane, in pixels
+     * @param [in] frameHeight height of the Y plane, in pixels
+     * @param [in] region part of the Y plane in which the cube is searched for
+     */
+    void configure(int frameWidth, int frameHeight, const cv::Rect &region);
+
+    /**
+     * @param [in] frameY the Y plane of the scan frame
+     * @param [out] skipReason ScanOutcome::SKIPPED_BLURRY or ScanOutcome::SKIPPED_UNCHANGED, if the frame should be skipped
+     * @return true if the frame should be processed
+     */
+    bool shouldProcess(const uint8_t *frameY, ScanOutcome &skipReason);
+
+    /**
+     * Reports the result of the frame last passed to ScanGate::shouldProcess(), if it was processed.
+     */
+    void onProcessed(bool cubeFound);
+
+private:
+    static constexpr int GATE_DIMENSION = 64;
+
+    /**
+     * Minimum variance of the Laplacian of the downscaled region. Downscaling already smooths the image a lot, so only strong
+     * blur, such as the motion blur of a moving camera, falls below this.
+     */
+    static constexpr double MIN_SHARPNESS = 20.0;
+
+    /**
+     * Minimum mean absolute difference, in gray levels, to the last frame in which the cube was not found. Above the sensor noise.
+     */
+    static constexpr double MIN_MOTION = 2.0;
+
+    static constexpr int MAX_CONSECUTIVE_SKIPS = 5;
+
+    int frameWidth = 0;
+
+    int frameHeight = 0;
+
+    cv::Rect region;
+
+    /**
+     * Downscaled region of the frame last passed to ScanGate::shouldProcess().
+     */
+    cv::Mat current;
+
+    /**
+     * Downscaled region of the last processed frame in which the cube was not found. Only valid while ScanGate::hasReference is set.
+     */
+    cv::Mat reference;
+
+    /**
+     * False if no frame was processed without finding the cube since ScanGate::configure(), or if the cube was found since.
+     */
+    bool hasReference = false;
+
+    cv::Mat laplacian;
+
+    int consecutiveSkips = 0;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_SCANGATE_HPP
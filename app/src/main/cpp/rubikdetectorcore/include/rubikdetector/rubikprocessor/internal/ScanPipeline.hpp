@@ -0,0 +1,135 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_SCANPIPELINE_HPP
+#define RUBIKDETECTOR_SCANPIPELINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../../utils/BoundedQueue.hpp"
+
+namespace rbdt {
+
+class OnCubeDetectionResultListener;
+
+/**
+ * Two stage pipeline used by the RubikProcessorImpl to process scan frames asynchronously.
+ *
+ * The first stage turns the NV21 scan frame into the three grayscale face images, the second one runs the facelets detection on
+ * them and notifies the OnCubeDetectionResultListener. Each stage runs on its own thread, so the preprocessing of frame N+1 overlaps
+ * with the detection of frame N and the throughput is bound by the slowest stage instead of the sum of both.
+ *
+ * The face images travel between the stages in a fixed number of slots allocated once by the pipeline. When all the slots are in use
+ * the preprocessing stage waits, and once the submission queue is also full ScanPipeline::submit() starts rejecting frames. This keeps
+ * both the memory usage & the latency of a submitted frame bounded.
+ *
+ * @warning Do not use ScanPipeline directly, do not expose this in the API. Use RubikProcessor::submitScan() instead.
+ */
+class ScanPipeline {
+public:
+    /**
+     * Writes the three face images of the scan frame into the given slot memory.
+     */
+    typedef std::function<void(const uint8_t *scanData, uint8_t *facesData)> PreprocessingStage;
+
+    /**
+     * Detects the cube in the three face images stored in the slot memory. Returns whether the cube was found.
+     */
+    typedef std::function<bool(uint8_t *facesData, int frameNumber)> DetectionStage;
+
+    /**
+     * Allocates the slots & starts the two stage threads.
+     *
+     * @param [in] depth number of frames that can be in flight between the two stages
+     * @param [in] facesByteCount size in bytes of the three face images of one frame
+     * @param [in] preprocessingStage work done by the first stage
+     * @param [in] detectionStage work done by the second stage
+     * @return a ScanPipeline
+     */
+    ScanPipeline(int depth, int facesByteCount, PreprocessingStage preprocessingStage, DetectionStage detectionStage);
+
+    /**
+     * Delivers the results of the frames already accepted, then joins the stage threads.
+     */
+    ~ScanPipeline();
+
+    ScanPipeline(const ScanPipeline &) = delete;
+
+    ScanPipeline &operator=(const ScanPipeline &) = delete;
+
+    void setListener(std::shared_ptr<OnCubeDetectionResultListener> listener);
+
+    /**
+     * Hands the frame to the first stage without blocking.
+     *
+     * @param [in] scanData the scan frame. Needs to stay valid until the listener is notified about it.
+     * @param [in] frameNumber number identifying the frame, passed back to the listener
+     * @return false if the pipeline is full and the frame was dropped, true otherwise
+     */
+    bool submit(const uint8_t *scanData, int frameNumber);
+
+    /**
+     * Blocks until the results of all the accepted frames have been delivered.
+     */
+    void flush();
+
+private:
+
+    struct ScanJob {
+        const uint8_t *scanData;
+        int frameNumber;
+        int slot;
+        /**
+         * False if the preprocessing stage failed. The job still goes through the detection stage, which reports it as not found
+         * without running the detection, so that the results keep the submission order.
+         */
+        bool preprocessed;
+    };
+
+    void preprocessingLoop();
+
+    void detectionLoop();
+
+    /**
+     * Frees the slot of the job & notifies the listener. Called only from the detection stage thread. An exception thrown by the
+     * listener is logged & swallowed, so that the stage keeps running and ScanPipeline::flush() still returns.
+     */
+    void onJobDone(const ScanJob &job, bool cubeFound);
+
+    const int facesByteCount;
+
+    PreprocessingStage preprocessingStage;
+
+    DetectionStage detectionStage;
+
+    std::vector<uint8_t> slotsMemory;
+
+    BoundedQueue<ScanJob> submittedJobs;
+
+    BoundedQueue<ScanJob> preprocessedJobs;
+
+    BoundedQueue<int> freeSlots;
+
+    std::mutex listenerMutex;
+
+    std::shared_ptr<OnCubeDetectionResultListener> listener;
+
+    std::mutex inFlightMutex;
+
+    std::condition_variable allDone;
+
+    int inFlightJobs = 0;
+
+    std::thread preprocessingThread;
+
+    std::thread detectionThread;
+};
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_SCANPIPELINE_HPP
@@ -0,0 +1,132 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_BOUNDEDQUEUE_HPP
+#define RUBIKDETECTOR_BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace rbdt {
+
+/**
+ * Thread safe FIFO queue holding at most a fixed number of elements.
+ *
+ * Producers either block until there is room (BoundedQueue::push()), give up immediately (BoundedQueue::tryPush()) or make room
+ * by discarding the oldest element (BoundedQueue::pushDroppingOldest()). Once
+ * BoundedQueue::close() is called all pushes fail, and consumers drain the remaining elements before BoundedQueue::pop() starts
+ * returning false.
+ *
+ * @tparam T the type of the queued elements
+ */
+    template<typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : capacity(capacity < 1 ? 1 : capacity) {}
+
+        BoundedQueue(const BoundedQueue &) = delete;
+
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        /**
+         * Blocks until there is room for the element, then enqueues it.
+         * @return false if the queue was closed, true otherwise
+         */
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this]() { return closed || items.size() < capacity; });
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            lock.unlock();
+            notEmpty.notify_one();
+            return true;
+        }
+
+        /**
+         * Enqueues the element only if that can be done without blocking.
+         * @return false if the queue is full or closed, true otherwise
+         */
+        bool tryPush(T item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (closed || items.size() >= capacity) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            lock.unlock();
+            notEmpty.notify_one();
+            return true;
+        }
+
+        /**
+         * Enqueues the element without ever blocking. If the queue is full its oldest element is discarded to make room.
+         * @param [out] dropped receives the discarded element, if any
+         * @return true if an element was discarded, false otherwise. Once the queue is closed the discarded element is the given one.
+         */
+        bool pushDroppingOldest(T item, T &dropped) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (closed) {
+                dropped = std::move(item);
+                return true;
+            }
+            bool full = items.size() >= capacity;
+            if (full) {
+                dropped = std::move(items.front());
+                items.pop_front();
+            }
+            items.push_back(std::move(item));
+            lock.unlock();
+            notEmpty.notify_one();
+            return full;
+        }
+
+        /**
+         * Blocks until an element is available and moves it into the output parameter.
+         * @param [out] item receives the dequeued element
+         * @return false if the queue is closed and empty, true otherwise
+         */
+        bool pop(T &item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this]() { return closed || !items.empty(); });
+            if (items.empty()) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            lock.unlock();
+            notFull.notify_one();
+            return true;
+        }
+
+        /**
+         * Rejects any further push and wakes up every blocked producer & consumer.
+         */
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            notEmpty.notify_all();
+            notFull.notify_all();
+        }
+
+    private:
+        const size_t capacity;
+
+        std::deque<T> items;
+
+        std::mutex mutex;
+
+        std::condition_variable notEmpty;
+
+        std::condition_variable notFull;
+
+        bool closed = false;
+    };
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_BOUNDEDQUEUE_HPP
@@ -0,0 +1,49 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_CIEDE2000BATCH_HPP
+#define RUBIKDETECTOR_CIEDE2000BATCH_HPP
+
+namespace rbdt {
+
+/**
+ * A list of colors in CIELAB, stored as one array per channel. The arrays are not owned.
+ */
+struct LabColors {
+    const float *l;
+
+    const float *a;
+
+    const float *b;
+
+    int count;
+};
+
+/**
+ * Largest difference between a distance computed by computeCIEDE2000Matrix() & the one computed by CIEDE2000::CIEDE2000() for the
+ * same colors, for L in [0, 100] and a, b in [-128, 127].
+ *
+ * Colors whose hues are almost exactly 180 degrees apart are the exception: the mean hue of the reference jumps by 180 degrees there,
+ * so a rounding error may put the two computations on different sides of the jump.
+ */
+constexpr float CIEDE2000_BATCH_MAX_ERROR = 1e-3f;
+
+/**
+ * Float, batched version of CIEDE2000::CIEDE2000(), which computes the distance between every color of <b>first</b> & every color of
+ * <b>second</b>.
+ *
+ * The formula is the same, but atan2, sin, cos & exp are replaced by polynomial approximations and the branches by selects, so
+ * several colors of <b>second</b> go through it at once with the OpenCV universal intrinsics. These map to NEON on the devices & to
+ * SSE on the host. When those are not available, or for the last colors of each row, the same approximations run one color at a time.
+ * The result stays within CIEDE2000_BATCH_MAX_ERROR of the reference.
+ *
+ * @param [in] first colors of the rows
+ * @param [in] second colors of the columns
+ * @param [out] distances receives first.count rows of second.count distances, in row major order. The distance between
+ * <b>first</b>[i] & <b>second</b>[j] is stored at i * second.count + j.
+ */
+void computeCIEDE2000Matrix(const LabColors &first, const LabColors &second, float *distances);
+
+} //namespace rbdt
+#endif //RUBIKDETECTOR_CIEDE2000BATCH_HPP
@@ -5,24 +5,99 @@
 #ifndef RUBIKDETECTOR_CROSSLOG_HPP
 #define RUBIKDETECTOR_CROSSLOG_HPP
 
-#ifdef __ANDROID__
+/**
+ * Log levels, matching the Android log priorities.
+ */
+#define RBDT_LOG_LEVEL_VERBOSE 2
+#define RBDT_LOG_LEVEL_DEBUG 3
+#define RBDT_LOG_LEVEL_WARN 5
+#define RBDT_LOG_LEVEL_ERROR 6
+#define RBDT_LOG_LEVEL_NONE 8
+
+/**
+ * Calls below this level compile to nothing, arguments included. Defaults to RBDT_LOG_LEVEL_WARN in release builds and
+ * RBDT_LOG_LEVEL_DEBUG otherwise. Define it in the build flags to override.
+ */
+#ifndef RBDT_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define RBDT_MIN_LOG_LEVEL RBDT_LOG_LEVEL_WARN
+#else
+#define RBDT_MIN_LOG_LEVEL RBDT_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+/**
+ * If 1, the retained messages are stored in the rbdt::LogBuffer and only reach the platform logger when it's flushed. An error
+ * flushes the buffer right away, so it's never lost & the messages leading to it come out first.
+ * Defaults to 1 in release builds and 0 otherwise.
+ */
+#ifndef RBDT_LOG_BUFFERED
+#ifdef NDEBUG
+#define RBDT_LOG_BUFFERED 1
+#else
+#define RBDT_LOG_BUFFERED 0
+#endif
+#endif
+
+#if RBDT_LOG_BUFFERED
+
+#include "LogBuffer.hpp"
+
+#define RBDT_LOG_WRITE(LEVEL, LOG_TAG, ...) rbdt::LogBuffer::instance().append((LEVEL), (LOG_TAG), __VA_ARGS__)
+
+#define RBDT_LOG_WRITE_ERROR(LOG_TAG, ...) \
+    (RBDT_LOG_WRITE(RBDT_LOG_LEVEL_ERROR, LOG_TAG, __VA_ARGS__), rbdt::LogBuffer::instance().flush())
+
+#elif defined(__ANDROID__)
 
 #include <android/log.h>
 
-#define LOG_VERBOSE(LOG_TAG, ...) __android_log_print(ANDROID_LOG_VERBOSE, (LOG_TAG), ## __VA_ARGS__)
-#define LOG_DEBUG(LOG_TAG, ...) __android_log_print(ANDROID_LOG_DEBUG, (LOG_TAG), ## __VA_ARGS__)
-#define LOG_WARN(LOG_TAG, ...) __android_log_print(ANDROID_LOG_WARN, (LOG_TAG), ## __VA_ARGS__)
-#define LOG_ERROR(LOG_TAG, ...) __android_log_print(ANDROID_LOG_ERROR, (LOG_TAG), ## __VA_ARGS__)
+#define RBDT_LOG_WRITE(LEVEL, LOG_TAG, ...) __android_log_print((LEVEL), (LOG_TAG), __VA_ARGS__)
 
 #else // Non-mobile platform
 
+#include <cstdio>
 #include <iostream>
 
-#define LOG_VERBOSE(LOG_TAG, ...) printf("\n" LOG_TAG ": " __VA_ARGS__)
-#define LOG_DEBUG(LOG_TAG, ...) printf("\n" LOG_TAG ": " __VA_ARGS__)
-#define LOG_WARN(LOG_TAG, ...) printf("\n" LOG_TAG ": " __VA_ARGS__)
-#define LOG_ERROR(LOG_TAG, ...) printf("\n" LOG_TAG ": " __VA_ARGS__)
+#define RBDT_LOG_WRITE(LEVEL, LOG_TAG, ...) printf("\n" LOG_TAG ": " __VA_ARGS__)
+
+#endif
+
+#if RBDT_MIN_LOG_LEVEL <= RBDT_LOG_LEVEL_VERBOSE
+#define LOG_VERBOSE(LOG_TAG, ...) RBDT_LOG_WRITE(RBDT_LOG_LEVEL_VERBOSE, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_VERBOSE(LOG_TAG, ...) ((void) 0)
+#endif
+
+#if RBDT_MIN_LOG_LEVEL <= RBDT_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(LOG_TAG, ...) RBDT_LOG_WRITE(RBDT_LOG_LEVEL_DEBUG, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(LOG_TAG, ...) ((void) 0)
+#endif
+
+#if RBDT_MIN_LOG_LEVEL <= RBDT_LOG_LEVEL_WARN
+#define LOG_WARN(LOG_TAG, ...) RBDT_LOG_WRITE(RBDT_LOG_LEVEL_WARN, LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_WARN(LOG_TAG, ...) ((void) 0)
+#endif
+
+#if RBDT_MIN_LOG_LEVEL <= RBDT_LOG_LEVEL_ERROR
+#if RBDT_LOG_BUFFERED
+#define LOG_ERROR(LOG_TAG, ...) RBDT_LOG_WRITE_ERROR(LOG_TAG, __VA_ARGS__)
+#else
+#define LOG_ERROR(LOG_TAG, ...) RBDT_LOG_WRITE(RBDT_LOG_LEVEL_ERROR, LOG_TAG, __VA_ARGS__)
+#endif
+#else
+#define LOG_ERROR(LOG_TAG, ...) ((void) 0)
+#endif
 
+/**
+ * Writes the messages held by the rbdt::LogBuffer to the platform logger. Does nothing when RBDT_LOG_BUFFERED is 0.
+ */
+#if RBDT_LOG_BUFFERED
+#define LOG_FLUSH() rbdt::LogBuffer::instance().flush()
+#else
+#define LOG_FLUSH() ((void) 0)
 #endif
 
 #endif //RUBIKDETECTOR_CROSSLOG_HPP
@@ -0,0 +1,91 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_LATENCYRECORDER_HPP
+#define RUBIKDETECTOR_LATENCYRECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "../data/metrics/StageLatency.hpp"
+
+namespace rbdt {
+
+/**
+ * Collects the latencies of the ProcessingStage values into fixed bucket histograms, shared by the whole library.
+ *
+ * Recording is a single atomic increment, so stages running concurrently on different threads can be timed without locking. The
+ * bucket bounds grow geometrically, four buckets per doubling, from 8 microseconds to several seconds.
+ *
+ * Do not use this directly, use ScopedStageTimer & RubikProcessor::getStageLatencies() instead.
+ */
+    class LatencyRecorder {
+    public:
+        static constexpr int BUCKET_COUNT = 80;
+
+        /**
+         * @return the recorder shared by the whole library
+         */
+        static LatencyRecorder &instance();
+
+        LatencyRecorder(const LatencyRecorder &) = delete;
+
+        LatencyRecorder &operator=(const LatencyRecorder &) = delete;
+
+        void record(ProcessingStage stage, int64_t micros);
+
+        /**
+         * @return the statistics of every stage, in the ProcessingStage declaration order
+         */
+        std::vector<StageLatency> snapshot() const;
+
+        /**
+         * Discards everything recorded so far.
+         */
+        void reset();
+
+    private:
+        static constexpr int STAGE_COUNT = static_cast<int>(ProcessingStage::COUNT);
+
+        LatencyRecorder();
+
+        int bucketOf(int64_t micros) const;
+
+        float percentileMillis(const uint32_t *bucketCounts, uint32_t count, float percentile) const;
+
+        /**
+         * Inclusive upper bound of each bucket, in microseconds. The last bucket also holds everything above its bound.
+         */
+        int64_t bucketUpperBounds[BUCKET_COUNT];
+
+        std::atomic<uint32_t> histograms[STAGE_COUNT][BUCKET_COUNT];
+    };
+
+/**
+ * Times the enclosing scope with a monotonic clock & records the result in the LatencyRecorder when it goes out of scope.
+ */
+    class ScopedStageTimer {
+    public:
+        explicit ScopedStageTimer(ProcessingStage stage) :
+                stage(stage),
+                start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedStageTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            LatencyRecorder::instance().record(stage, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        }
+
+        ScopedStageTimer(const ScopedStageTimer &) = delete;
+
+        ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+    private:
+        const ProcessingStage stage;
+
+        const std::chrono::steady_clock::time_point start;
+    };
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_LATENCYRECORDER_HPP
@@ -0,0 +1,92 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_LOGBUFFER_HPP
+#define RUBIKDETECTOR_LOGBUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace rbdt {
+
+/**
+ * In memory ring buffer holding the most recent log messages, used by the CrossLog macros when RBDT_LOG_BUFFERED is enabled.
+ *
+ * Appending a message never blocks & never reaches the platform logger: the writer claims a slot with a single atomic increment,
+ * formats the message into it and publishes it. Messages only reach the platform logger when LogBuffer::flush() is called. When
+ * more than LogBuffer::CAPACITY messages are appended between two flushes, the oldest ones are overwritten.
+ *
+ * Do not use this directly, use the LOG_* macros from CrossLog.hpp instead.
+ */
+    class LogBuffer {
+    public:
+        /**
+         * Number of messages kept between two flushes.
+         */
+        static constexpr int CAPACITY = 256;
+
+        /**
+         * Maximum length of a message, longer ones are truncated.
+         */
+        static constexpr int MESSAGE_LENGTH = 192;
+
+        /**
+         * @return the buffer shared by the whole library
+         */
+        static LogBuffer &instance();
+
+        LogBuffer(const LogBuffer &) = delete;
+
+        LogBuffer &operator=(const LogBuffer &) = delete;
+
+        /**
+         * Formats the message into the next slot of the buffer. Safe to call from any thread.
+         *
+         * @param [in] level one of the RBDT_LOG_LEVEL_* values
+         * @param [in] tag the log tag. Needs to outlive the buffer, i.e. should be a string literal.
+         * @param [in] format printf style format, followed by its arguments
+         */
+        void append(int level, const char *tag, const char *format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 4, 5)))
+#endif
+        ;
+
+        /**
+         * Writes the messages appended since the last flush to the platform logger, oldest first. Messages still being written by
+         * another thread when this is called are skipped.
+         */
+        void flush();
+
+    private:
+        LogBuffer();
+
+        struct Entry {
+            /**
+             * 2 * index + 1 while the message with the given index is being written, 2 * index + 2 once it's complete.
+             */
+            std::atomic<uint64_t> sequence;
+
+            int level;
+
+            const char *tag;
+
+            char message[MESSAGE_LENGTH];
+        };
+
+        std::atomic<uint64_t> nextIndex;
+
+        /**
+         * Index of the first message not flushed yet. Guarded by LogBuffer::flushMutex.
+         */
+        uint64_t nextFlushIndex = 0;
+
+        std::mutex flushMutex;
+
+        Entry entries[CAPACITY];
+    };
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_LOGBUFFER_HPP
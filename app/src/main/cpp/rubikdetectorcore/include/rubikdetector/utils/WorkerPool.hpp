@@ -0,0 +1,154 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_WORKERPOOL_HPP
+#define RUBIKDETECTOR_WORKERPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rbdt {
+
+/**
+ * Task handed to WorkerPool::post(). The caller owns it & keeps it alive until it has run, which lets the same task object be posted
+ * on every frame without any allocation.
+ */
+    class PooledTask {
+    public:
+        virtual ~PooledTask() {}
+
+        /**
+         * Runs on one of the worker threads. Must not throw, failures need to be stored in the task for its owner to handle.
+         */
+        virtual void run() = 0;
+    };
+
+/**
+ * Lets a thread wait for a fixed number of PooledTask objects to finish. Each task calls TaskLatch::countDown() as the very last thing
+ * it does, after which neither the task nor the latch is touched by the worker anymore.
+ */
+    class TaskLatch {
+    public:
+        /**
+         * @param [in] count number of TaskLatch::countDown() calls TaskLatch::wait() waits for
+         */
+        explicit TaskLatch(int count);
+
+        TaskLatch(const TaskLatch &) = delete;
+
+        TaskLatch &operator=(const TaskLatch &) = delete;
+
+        void countDown();
+
+        /**
+         * Blocks until TaskLatch::countDown() was called as many times as the count given to the constructor.
+         */
+        void wait();
+
+    private:
+        std::mutex mutex;
+
+        std::condition_variable condition;
+
+        int pending;
+    };
+
+/**
+ * Fixed size pool of worker threads which execute submitted tasks in FIFO order.
+ *
+ * The threads are created once, when the pool is constructed, and are kept alive until the pool is destroyed. This makes
+ * it cheap to hand work to the pool on every processed frame, since no thread is created or joined on the hot path.
+ *
+ * Results (and exceptions) of the submitted tasks are returned to the caller through a std::future. Since that costs a few heap
+ * allocations per task, the per frame fan-outs go through WorkerPool::post() instead, which doesn't allocate once the pool warmed up.
+ */
+    class WorkerPool {
+    public:
+        /**
+         * Creates the pool and starts its worker threads.
+         *
+         * @param [in] threadCount number of worker threads. Values lower than 1 are treated as 1.
+         * @return a WorkerPool
+         */
+        explicit WorkerPool(int threadCount);
+
+        /**
+         * Lets the workers finish the tasks already queued, then joins them.
+         */
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        /**
+         * Queues a task for execution on one of the worker threads.
+         *
+         * @param [in] task callable taking no arguments
+         * @return a std::future holding the value returned by the task, or the exception it threw
+         */
+        template<typename TASK>
+        auto submit(TASK task) -> std::future<decltype(task())> {
+            typedef decltype(task()) RESULT_TYPE;
+            // std::function needs a copyable target, hence the shared_ptr around the move-only packaged_task
+            std::shared_ptr<std::packaged_task<RESULT_TYPE()>> packagedTask =
+                    std::make_shared<std::packaged_task<RESULT_TYPE()>>(std::move(task));
+            std::future<RESULT_TYPE> result = packagedTask->get_future();
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                tasks.emplace_back([packagedTask]() { (*packagedTask)(); });
+            }
+            queueCondition.notify_one();
+            return result;
+        }
+
+        /**
+         * Queues a task owned by the caller for execution on one of the worker threads. Queued tasks are run before the ones passed to
+         * WorkerPool::submit(). The caller is notified through its own means, typically a TaskLatch.
+         *
+         * Does not allocate, as long as no more than WorkerPool::POSTED_TASK_CAPACITY tasks are waiting at once.
+         *
+         * @param [in] task run once, then forgotten by the pool
+         */
+        void post(PooledTask &task);
+
+        /**
+         * @return the number of worker threads owned by this pool
+         */
+        int size() const;
+
+    private:
+
+        /**
+         * Room reserved for the tasks waiting in WorkerPool::postedTasks.
+         */
+        static constexpr int POSTED_TASK_CAPACITY = 16;
+
+        void workerLoop();
+
+        std::vector<std::thread> workers;
+
+        std::deque<std::function<void()>> tasks;
+
+        /**
+         * Tasks passed to WorkerPool::post() which haven't started yet, oldest first. Only ever erased from the front, so its storage
+         * is kept.
+         */
+        std::vector<PooledTask *> postedTasks;
+
+        std::mutex queueMutex;
+
+        std::condition_variable queueCondition;
+
+        bool stopping = false;
+    };
+
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_WORKERPOOL_HPP
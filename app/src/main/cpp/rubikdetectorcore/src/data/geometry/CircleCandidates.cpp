@@ -0,0 +1,163 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core/hal/intrin.hpp>
+#include "../../../include/rubikdetector/data/geometry/internal/CircleCandidates.hpp"
+
+namespace rbdt {
+
+void CircleCandidates::assign(const std::vector<Circle> &circles) {
+    centerX.resize(circles.size());
+    centerY.resize(circles.size());
+    radius.resize(circles.size());
+    area.resize(circles.size());
+    angle.resize(circles.size());
+    for (int i = 0; i < (int) circles.size(); i++) {
+        centerX[i] = circles[i].center.x;
+        centerY[i] = circles[i].center.y;
+        radius[i] = circles[i].radius;
+        area[i] = (float) circles[i].area;
+        angle[i] = circles[i].angle;
+    }
+}
+
+void CircleCandidates::assign(const std::vector<Circle> &circles, const std::vector<int> &order) {
+    centerX.resize(order.size());
+    centerY.resize(order.size());
+    radius.resize(order.size());
+    area.resize(order.size());
+    angle.resize(order.size());
+    for (int slot = 0; slot < (int) order.size(); slot++) {
+        const Circle &circle = circles[order[slot]];
+        centerX[slot] = circle.center.x;
+        centerY[slot] = circle.center.y;
+        radius[slot] = circle.radius;
+        area[slot] = (float) circle.area;
+        angle[slot] = circle.angle;
+    }
+}
+
+int CircleCandidates::size() const {
+    return (int) centerX.size();
+}
+
+void CircleCandidates::selectSimilar(const Circle &reference, float maxDistance, float maxAreaRatio, float maxAngleDifference,
+                                     int begin, int end, std::vector<int> &slots) const {
+    int slot = begin;
+#if CV_SIMD128
+    const cv::v_float32x4 referenceX = cv::v_setall_f32(reference.center.x);
+    const cv::v_float32x4 referenceY = cv::v_setall_f32(reference.center.y);
+    const cv::v_float32x4 squaredMaxDistance = cv::v_setall_f32(maxDistance * maxDistance);
+    const cv::v_float32x4 ratio = cv::v_setall_f32(maxAreaRatio);
+    const cv::v_float32x4 referenceArea = cv::v_setall_f32((float) reference.area);
+    const cv::v_float32x4 scaledReferenceArea = cv::v_setall_f32(maxAreaRatio * reference.area);
+    const cv::v_float32x4 referenceAngle = cv::v_setall_f32(reference.angle);
+    const cv::v_float32x4 angleThreshold = cv::v_setall_f32(maxAngleDifference);
+    for (; slot + 4 <= end; slot += 4) {
+        cv::v_float32x4 dx = cv::v_load(&centerX[slot]) - referenceX;
+        cv::v_float32x4 dy = cv::v_load(&centerY[slot]) - referenceY;
+        cv::v_float32x4 candidateArea = cv::v_load(&area[slot]);
+        cv::v_float32x4 kept = (dx * dx + dy * dy <= squaredMaxDistance) &
+                               (candidateArea < scaledReferenceArea) &
+                               (referenceArea < candidateArea * ratio) &
+                               (cv::v_abs(cv::v_load(&angle[slot]) - referenceAngle) < angleThreshold);
+        int lanes = cv::v_signmask(kept);
+        for (int lane = 0; lanes != 0; lane++, lanes >>= 1) {
+            if (lanes & 1) {
+                slots.push_back(slot + lane);
+            }
+        }
+    }
+#endif
+    selectSimilarScalar(reference, maxDistance, maxAreaRatio, maxAngleDifference, slot, end, slots);
+}
+
+void CircleCandidates::findContaining(const cv::Point2f &point, std::vector<int> &slots) const {
+    slots.clear();
+    int slot = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 pointX = cv::v_setall_f32(point.x);
+    const cv::v_float32x4 pointY = cv::v_setall_f32(point.y);
+    for (; slot + 4 <= size(); slot += 4) {
+        cv::v_float32x4 candidateRadius = cv::v_load(&radius[slot]);
+        cv::v_float32x4 contained = (cv::v_abs(pointX - cv::v_load(&centerX[slot])) < candidateRadius) &
+                                    (cv::v_abs(pointY - cv::v_load(&centerY[slot])) < candidateRadius);
+        int lanes = cv::v_signmask(contained);
+        for (int lane = 0; lanes != 0; lane++, lanes >>= 1) {
+            if (lanes & 1) {
+                slots.push_back(slot + lane);
+            }
+        }
+    }
+#endif
+    findContainingScalar(point, slot, slots);
+}
+
+float CircleCandidates::findSmallestGap(const Circle &reference, float maxOffset, float upperBound) const {
+    int slot = 0;
+    float smallestGap = upperBound;
+#if CV_SIMD128
+    const cv::v_float32x4 referenceX = cv::v_setall_f32(reference.center.x);
+    const cv::v_float32x4 referenceY = cv::v_setall_f32(reference.center.y);
+    const cv::v_float32x4 referenceRadius = cv::v_setall_f32(reference.radius);
+    const cv::v_float32x4 offsetThreshold = cv::v_setall_f32(maxOffset);
+    const cv::v_float32x4 zero = cv::v_setzero_f32();
+    const cv::v_float32x4 noGap = cv::v_setall_f32(upperBound);
+    cv::v_float32x4 smallestGaps = noGap;
+    for (; slot + 4 <= size(); slot += 4) {
+        cv::v_float32x4 dx = cv::v_load(&centerX[slot]) - referenceX;
+        cv::v_float32x4 dy = cv::v_load(&centerY[slot]) - referenceY;
+        cv::v_float32x4 gap = cv::v_sqrt(dx * dx + dy * dy) - referenceRadius - cv::v_load(&radius[slot]);
+        cv::v_float32x4 contained = (cv::v_abs(dx) < referenceRadius) & (cv::v_abs(dy) < referenceRadius);
+        cv::v_float32x4 counted = ~contained & (dx <= offsetThreshold) & (dy <= offsetThreshold) & (gap > zero);
+        smallestGaps = cv::v_min(smallestGaps, cv::v_select(counted, gap, noGap));
+    }
+    smallestGap = cv::v_reduce_min(smallestGaps);
+#endif
+    return findSmallestGapScalar(reference, maxOffset, smallestGap, slot);
+}
+
+void CircleCandidates::selectSimilarScalar(const Circle &reference, float maxDistance, float maxAreaRatio,
+                                           float maxAngleDifference, int begin, int end, std::vector<int> &slots) const {
+    const float squaredMaxDistance = maxDistance * maxDistance;
+    const float scaledReferenceArea = maxAreaRatio * reference.area;
+    for (int slot = begin; slot < end; slot++) {
+        float dx = centerX[slot] - reference.center.x;
+        float dy = centerY[slot] - reference.center.y;
+        if (dx * dx + dy * dy <= squaredMaxDistance &&
+            area[slot] < scaledReferenceArea &&
+            reference.area < area[slot] * maxAreaRatio &&
+            std::abs(angle[slot] - reference.angle) < maxAngleDifference) {
+            slots.push_back(slot);
+        }
+    }
+}
+
+void CircleCandidates::findContainingScalar(const cv::Point2f &point, int begin, std::vector<int> &slots) const {
+    for (int slot = begin; slot < size(); slot++) {
+        if (std::abs(point.x - centerX[slot]) < radius[slot] && std::abs(point.y - centerY[slot]) < radius[slot]) {
+            slots.push_back(slot);
+        }
+    }
+}
+
+float CircleCandidates::findSmallestGapScalar(const Circle &reference, float maxOffset, float upperBound, int begin) const {
+    float smallestGap = upperBound;
+    for (int slot = begin; slot < size(); slot++) {
+        float dx = centerX[slot] - reference.center.x;
+        float dy = centerY[slot] - reference.center.y;
+        if ((std::abs(dx) < reference.radius && std::abs(dy) < reference.radius) || dx > maxOffset || dy > maxOffset) {
+            continue;
+        }
+        float gap = std::sqrt(dx * dx + dy * dy) - reference.radius - radius[slot];
+        if (gap < smallestGap && gap > 0) {
+            smallestGap = gap;
+        }
+    }
+    return smallestGap;
+}
+
+} //namespace rbdt
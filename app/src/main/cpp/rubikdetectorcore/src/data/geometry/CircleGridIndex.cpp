@@ -0,0 +1,62 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include "../../../include/rubikdetector/data/geometry/internal/CircleGridIndex.hpp"
+
+namespace rbdt {
+
+void CircleGridIndex::build(const std::vector<Circle> &circles, const cv::Size &frameSize) {
+    cellWidth = std::max(1.0f, (float) frameSize.width / CELLS_PER_SIDE);
+    cellHeight = std::max(1.0f, (float) frameSize.height / CELLS_PER_SIDE);
+
+    // Counting sort of the circles by cell: count, turn the counts into starts, then place
+    cellStarts.assign(CELLS_PER_SIDE * CELLS_PER_SIDE + 1, 0);
+    for (const Circle &circle : circles) {
+        cellStarts[cellRow(circle.center.y) * CELLS_PER_SIDE + cellColumn(circle.center.x) + 1]++;
+    }
+    for (int cell = 0; cell < CELLS_PER_SIDE * CELLS_PER_SIDE; cell++) {
+        cellStarts[cell + 1] += cellStarts[cell];
+    }
+    cellCircles.resize(circles.size());
+    nextSlots.assign(cellStarts.begin(), cellStarts.end() - 1);
+    for (int i = 0; i < (int) circles.size(); i++) {
+        cellCircles[nextSlots[cellRow(circles[i].center.y) * CELLS_PER_SIDE + cellColumn(circles[i].center.x)]++] = i;
+    }
+    candidates.assign(circles, cellCircles);
+}
+
+void CircleGridIndex::findSimilarInRadius(const Circle &reference, float radius, float maxAreaRatio, float maxAngleDifference,
+                                          std::vector<int> &indices) const {
+    indices.clear();
+    if (cellStarts.empty()) {
+        return;
+    }
+    const int firstColumn = cellColumn(reference.center.x - radius);
+    const int lastColumn = cellColumn(reference.center.x + radius);
+    const int firstRow = cellRow(reference.center.y - radius);
+    const int lastRow = cellRow(reference.center.y + radius);
+    foundSlots.clear();
+    for (int row = firstRow; row <= lastRow; row++) {
+        // The cells of a row are next to each other in the buffer
+        candidates.selectSimilar(reference, radius, maxAreaRatio, maxAngleDifference,
+                                 cellStarts[row * CELLS_PER_SIDE + firstColumn],
+                                 cellStarts[row * CELLS_PER_SIDE + lastColumn + 1], foundSlots);
+    }
+    for (int slot : foundSlots) {
+        indices.push_back(cellCircles[slot]);
+    }
+    // Callers rely on the original order of the circles, e.g. when several of them match the same estimated facelet
+    std::sort(indices.begin(), indices.end());
+}
+
+int CircleGridIndex::cellColumn(float x) const {
+    return std::min(CELLS_PER_SIDE - 1, std::max(0, (int) (x / cellWidth)));
+}
+
+int CircleGridIndex::cellRow(float y) const {
+    return std::min(CELLS_PER_SIDE - 1, std::max(0, (int) (y / cellHeight)));
+}
+
+} //namespace rbdt
@@ -10,6 +10,4 @@ Point2d::Point2d() : Point2d(0, 0) {}
 
 Point2d::Point2d(float x, float y) : x(x), y(y) {}
 
-Point2d::~Point2d() {}
-
 } //end namespace rbdt
@@ -2,18 +2,18 @@
 // Created by Kohru on 29/11/2019.
 //
 
-#include <utility>
 #include "../../../include/rubikdetector/data/processing/CubeState.h"
 
 
 namespace rbdt {
 
-    CubeState::CubeState() : CubeState(std::vector<Face>(), std::vector<cv::Scalar>()) {}
+    CubeState::CubeState() : valid(false) {
+        facelets.fill(Face::UP);
+    }
 
-    CubeState::CubeState(std::vector<Face> facelets, std::vector<cv::Scalar> colors)
-            : facelets(std::move(facelets)),
-              colors(std::move(colors)) {}
+    CubeState::CubeState(const std::array<Face, FACELET_COUNT> &facelets, const std::array<cv::Scalar, FACE_COUNT> &colors)
+            : facelets(facelets),
+              colors(colors),
+              valid(true) {}
 
-    CubeState::~CubeState() {}
-
-} //end namespace rbdt
\ No newline at end of file
+} //end namespace rbdt
@@ -0,0 +1,21 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include "../../../include/rubikdetector/data/processing/FaceGrid.hpp"
+
+namespace rbdt {
+
+FaceGrid::FaceGrid() : found(false) {
+    confidence.fill(0);
+}
+
+RubikFacelet &FaceGrid::at(int row, int column) {
+    return facelets[row * 3 + column];
+}
+
+const RubikFacelet &FaceGrid::at(int row, int column) const {
+    return facelets[row * 3 + column];
+}
+
+} //end namespace rbdt
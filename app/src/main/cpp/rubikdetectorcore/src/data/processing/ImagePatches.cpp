@@ -0,0 +1,26 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <opencv2/core/core.hpp>
+#include "../../../include/rubikdetector/data/processing/ImagePatches.hpp"
+
+namespace rbdt {
+
+    ImagePatches::ImagePatches() : ImagePatches(nullptr, 0, 0, 0, CV_8UC3, 0, ColorSpace::BGR) {}
+
+    ImagePatches::ImagePatches(uint8_t *data, int count, int width, int height, int type, size_t patchStep,
+                               ColorSpace colorSpace) :
+            data(data),
+            count(count),
+            width(width),
+            height(height),
+            type(type),
+            patchStep(patchStep),
+            colorSpace(colorSpace) {}
+
+    cv::Mat ImagePatches::patch(int index) const {
+        return cv::Mat(height, width, type, data + index * patchStep);
+    }
+
+} //end namespace rbdt
@@ -16,9 +16,7 @@ RubikFacelet::RubikFacelet(Point2d center, float width, float height, float angl
           angle(angle),
           color(color) {}
 
-RubikFacelet::~RubikFacelet() {}
-
-std::vector<Point2d> RubikFacelet::corners() {
+std::vector<Point2d> RubikFacelet::corners() const {
     std::vector<Point2d> result(4);
     float angleSinHalf = std::sin(angle) * 0.5f;
     float angleCosHalf = std::cos(angle) * 0.5f;
@@ -37,7 +35,7 @@ std::vector<Point2d> RubikFacelet::corners() {
     return result;
 }
 
-float RubikFacelet::innerCircleRadius() {
+float RubikFacelet::innerCircleRadius() const {
     return std::min(width, height) / 2;
 }
 
@@ -26,4 +26,10 @@ namespace rbdt {
         return colorDetectorImpl->detectColor(image, whiteRatio, regionInfo, frameNr);
     }
 
+    void HistogramColorDetector::detectColors(const ImagePatches &patches,
+                                              const float whiteRatio,
+                                              std::vector<ColorDetection> &detections) {
+        colorDetectorImpl->detectColors(patches, whiteRatio, detections);
+    }
+
 } //end namespace rbdt
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "../../../include/rubikdetector/detectors/colordetector/internal/HistogramColorDetectorImpl.hpp"
 
+#include <algorithm>
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
 #include "../../../include/rubikdetector/data/processing/internal/HueColorEvidence.hpp"
@@ -31,15 +32,67 @@ namespace rbdt {
                                                                 const float whiteRatio,
                                                                 const int regionInfo,
                                                                 const int frameNr) {
-
-        std::vector<cv::Mat> hsvChannels;
-        //split the HSV into 3 other Mat, one for each color channel
-        split(image, hsvChannels);
-
         int saturationHistogram[SATURATION_HISTOGRAM_SIZE];
+        int hueHistogram[HUE_BUFFER_SIZE];
         int nrNonGrayPixels = 0;
-        computeSaturationHistogram(hsvChannels, saturationHistogram, nrNonGrayPixels);
+        computeHistograms(image, saturationHistogram, hueHistogram, nrNonGrayPixels);
+
+        bool isWhite = false;
+        float confidence = 0;
+        RubikFacelet::Color color = classify(saturationHistogram, hueHistogram, nrNonGrayPixels, whiteRatio, isWhite, confidence);
+        if (isSavingImages(imageSaver)) {
+            //print the histogram the color was picked from, if in debug mode
+            if (isWhite) {
+                printOwnHistogram(saturationHistogram, SATURATION_HISTOGRAM_SIZE, frameNr, regionInfo);
+            } else {
+                printOwnHistogram(hueHistogram, HUE_HISTOGRAM_SIZE, frameNr, regionInfo);
+            }
+            // Converted into a copy, the input image belongs to the caller
+            cv::Mat bgrImage;
+            cv::cvtColor(image, bgrImage, cv::COLOR_HSV2BGR);
+            imageSaver->saveImage(bgrImage, frameNr, regionInfo);
+        }
+        return color;
+    }
+
+    void HistogramColorDetectorImpl::detectColors(const ImagePatches &patches,
+                                                  const float whiteRatio,
+                                                  std::vector<ColorDetection> &detections) {
+        int saturationHistogram[SATURATION_HISTOGRAM_SIZE];
+        int hueHistogram[HUE_BUFFER_SIZE];
+        detections.resize(patches.count);
+        ImagePatches hsvView = patches;
+        if (patches.colorSpace == ImagePatches::ColorSpace::BGR && patches.count > 0) {
+            hsvPatches.create(patches.count * patches.height, patches.width, patches.type);
+            const size_t patchByteCount = patches.width * patches.height * CV_ELEM_SIZE(patches.type);
+            if (patches.patchStep == patchByteCount) {
+                // Back to back, e.g. the facelets of the shared buffer: all of them are converted at once
+                cv::Mat bgrPatches(patches.count * patches.height, patches.width, patches.type, patches.data);
+                cv::cvtColor(bgrPatches, hsvPatches, cv::COLOR_BGR2HSV);
+            } else {
+                for (int i = 0; i < patches.count; i++) {
+                    cv::Mat hsvPatch = hsvPatches.rowRange(i * patches.height, (i + 1) * patches.height);
+                    cv::cvtColor(patches.patch(i), hsvPatch, cv::COLOR_BGR2HSV);
+                }
+            }
+            hsvView = ImagePatches(hsvPatches.data, patches.count, patches.width, patches.height, patches.type, patchByteCount,
+                                   ImagePatches::ColorSpace::HSV);
+        }
+        for (int i = 0; i < patches.count; i++) {
+            int nrNonGrayPixels = 0;
+            computeHistograms(hsvView.patch(i), saturationHistogram, hueHistogram, nrNonGrayPixels);
+            bool isWhite = false;
+            detections[i].color = classify(saturationHistogram, hueHistogram, nrNonGrayPixels, whiteRatio, isWhite,
+                                           detections[i].confidence);
+        }
+    }
 
+    RubikFacelet::Color HistogramColorDetectorImpl::classify(const int *saturationHistogram,
+                                                             const int *hueHistogram,
+                                                             const int nrNonGrayPixels,
+                                                             const float whiteRatio,
+                                                             bool &isWhite,
+                                                             float &confidence) const {
         int nrWhitePixels = 0;
         for (int i = 0; i <= SATURATION_THRESHOLD; i++) {
             nrWhitePixels += saturationHistogram[i];
@@ -47,83 +100,62 @@ namespace rbdt {
 
         float whitePixelRatio = (float) nrWhitePixels / nrNonGrayPixels;
 
-        if (whitePixelRatio > whiteRatio) {
+        isWhite = whitePixelRatio > whiteRatio;
+        if (isWhite) {
             //if the majority of the saturation values are in the "almost white" range of the saturation domain, then assume color is white
-            if (imageSaver != nullptr) {
-                //print saturation histogram, if in debug mode
-                printOwnHistogram(saturationHistogram, SATURATION_HISTOGRAM_SIZE, frameNr, regionInfo);
-                cv::cvtColor(image, image, cv::COLOR_HSV2BGR);
-                imageSaver->saveImage(image, frameNr, regionInfo);
-            }
+            confidence = whitePixelRatio;
             return RubikFacelet::Color::WHITE;
-        } else {
-            uchar pixelHsvHue, pixelHsvValue;
-            int hueHistogram[HUE_HISTOGRAM_SIZE];
-            for (int i = 0; i < HUE_HISTOGRAM_SIZE; i++) {
-                //ensure all values are 0
-                hueHistogram[i] = 0;
-            }
-            for (int i = 0; i < image.rows; i++) {
-                for (int j = 0; j < image.cols; j++) {
-                    pixelHsvHue = hsvChannels[HUE].at<uchar>(i, j);
-                    pixelHsvValue = hsvChannels[VALUE].at<uchar>(i, j);
-                    if (pixelHsvValue > MIN_HSV_VALUE_NON_GRAY) {
-                        //if the pixel has just enough color to not be considered gray scale, add it to the histogram
-                        hueHistogram[pixelHsvHue]++;
-                    }
-                }
-            }
+        }
 
-            //create 5 color buckets(white is excluded)
-            HueColorEvidence colorEvidence[5] = {HueColorEvidence(RubikFacelet::Color::RED),
-                                                 HueColorEvidence(RubikFacelet::Color::ORANGE),
-                                                 HueColorEvidence(RubikFacelet::Color::YELLOW),
-                                                 HueColorEvidence(RubikFacelet::Color::GREEN),
-                                                 HueColorEvidence(RubikFacelet::Color::BLUE)};
-
-            //partition the values in the 5 color buckets
-            //add the value at each histogram position as evidence to a particular color bucket
-            for (int i = 0; i < HUE_HISTOGRAM_SIZE; i++) {
-                if (i >= BUCKET_ORANGE_MIN_THRESHOLD && i <= BUCKET_ORANGE_MAX_THRESHOLD) {
-                    colorEvidence[rbdt::asInt(RubikFacelet::Color::ORANGE)]
-                            .evidence += hueHistogram[i];
-                } else if (i > BUCKET_YELLOW_MIN_THRESHOLD && i <= BUCKET_YELLOW_MAX_THRESHOLD) {
-                    colorEvidence[rbdt::asInt(RubikFacelet::Color::YELLOW)]
-                            .evidence += hueHistogram[i];
-                } else if (i > BUCKET_GREEN_MIN_THRESHOLD && i <= BUCKET_GREEN_MAX_THRESHOLD) {
-                    colorEvidence[rbdt::asInt(RubikFacelet::Color::GREEN)]
-                            .evidence += hueHistogram[i];
-                } else if (i > BUCKET_BLUE_MIN_THRESHOLD && i <= BUCKET_BLUE_MAX_THRESHOLD) {
-                    colorEvidence[rbdt::asInt(RubikFacelet::Color::BLUE)]
-                            .evidence += hueHistogram[i];
-                } else if ((i >= BUCKET_RED_MIN_THRESHOLD_1 && i <= BUCKET_RED_MAX_THRESHOLD_1) ||
-                           (i >= BUCKET_RED_MIN_THRESHOLD_2 && i < BUCKET_RED_MAX_THRESHOLD_2)) {
-                    colorEvidence[rbdt::asInt(RubikFacelet::Color::RED)]
-                            .evidence += hueHistogram[i];
-                }
+        //create 5 color buckets(white is excluded)
+        HueColorEvidence colorEvidence[5] = {HueColorEvidence(RubikFacelet::Color::RED),
+                                             HueColorEvidence(RubikFacelet::Color::ORANGE),
+                                             HueColorEvidence(RubikFacelet::Color::YELLOW),
+                                             HueColorEvidence(RubikFacelet::Color::GREEN),
+                                             HueColorEvidence(RubikFacelet::Color::BLUE)};
+
+        //partition the values in the 5 color buckets
+        //add the value at each histogram position as evidence to a particular color bucket
+        for (int i = 0; i < HUE_HISTOGRAM_SIZE; i++) {
+            if (i >= BUCKET_ORANGE_MIN_THRESHOLD && i <= BUCKET_ORANGE_MAX_THRESHOLD) {
+                colorEvidence[rbdt::asInt(RubikFacelet::Color::ORANGE)]
+                        .evidence += hueHistogram[i];
+            } else if (i > BUCKET_YELLOW_MIN_THRESHOLD && i <= BUCKET_YELLOW_MAX_THRESHOLD) {
+                colorEvidence[rbdt::asInt(RubikFacelet::Color::YELLOW)]
+                        .evidence += hueHistogram[i];
+            } else if (i > BUCKET_GREEN_MIN_THRESHOLD && i <= BUCKET_GREEN_MAX_THRESHOLD) {
+                colorEvidence[rbdt::asInt(RubikFacelet::Color::GREEN)]
+                        .evidence += hueHistogram[i];
+            } else if (i > BUCKET_BLUE_MIN_THRESHOLD && i <= BUCKET_BLUE_MAX_THRESHOLD) {
+                colorEvidence[rbdt::asInt(RubikFacelet::Color::BLUE)]
+                        .evidence += hueHistogram[i];
+            } else if ((i >= BUCKET_RED_MIN_THRESHOLD_1 && i <= BUCKET_RED_MAX_THRESHOLD_1) ||
+                       (i >= BUCKET_RED_MIN_THRESHOLD_2 && i < BUCKET_RED_MAX_THRESHOLD_2)) {
+                colorEvidence[rbdt::asInt(RubikFacelet::Color::RED)]
+                        .evidence += hueHistogram[i];
             }
+        }
 
-            //sort the colors in descending evidence order
-            std::sort(colorEvidence, colorEvidence + 5,
-                      [](const HueColorEvidence &firstItem, const HueColorEvidence &secondItem) {
-                          return firstItem.evidence > secondItem.evidence;
-                      });
+        int totalEvidence = 0;
+        for (const HueColorEvidence &evidence : colorEvidence) {
+            totalEvidence += evidence.evidence;
+        }
 
-            if (imageSaver != nullptr) {
-                printOwnHistogram(hueHistogram, HUE_HISTOGRAM_SIZE, frameNr, regionInfo);
-                cv::cvtColor(image, image, cv::COLOR_HSV2BGR);
-                imageSaver->saveImage(image, frameNr, regionInfo);
-            }
+        //sort the colors in descending evidence order
+        std::sort(colorEvidence, colorEvidence + 5,
+                  [](const HueColorEvidence &firstItem, const HueColorEvidence &secondItem) {
+                      return firstItem.evidence > secondItem.evidence;
+                  });
 
-            //return the color with most evidence,i.e. the first in the sorted evidence array
-            return colorEvidence[0].color;
-        }
+        //return the color with most evidence,i.e. the first in the sorted evidence array
+        confidence = totalEvidence > 0 ? (float) colorEvidence[0].evidence / totalEvidence : 0.0f;
+        return colorEvidence[0].color;
     }
 
     void HistogramColorDetectorImpl::printOwnHistogram(const int hist[], const int histogramSize,
                                                        const int frameNumber,
                                                        const int regionId) const {
-        if (imageSaver == nullptr) {
+        if (!isSavingImages(imageSaver)) {
             //do nothing
             return;
         }
@@ -145,25 +177,36 @@ namespace rbdt {
         imageSaver->saveImage(histImage, frameNumber, regionIdStringStream.str());
     }
 
-    void HistogramColorDetectorImpl::computeSaturationHistogram(const std::vector<cv::Mat> &hsvChannels,
-                                                                int *saturationHistogram,
-                                                                int &nrNonGrayPixels) const {
-        uchar pixelHsvSaturation, pixelHsvValue;
-        for (int i = 0; i < SATURATION_HISTOGRAM_SIZE; i++) {
-            saturationHistogram[i] = 0;
-        }
-
-        for (int i = 0; i < hsvChannels[SATURATION].rows; i++) {
-            for (int j = 0; j < hsvChannels[SATURATION].cols; j++) {
-                pixelHsvSaturation = hsvChannels[SATURATION].at<uchar>(i, j);
-                pixelHsvValue = hsvChannels[VALUE].at<uchar>(i, j);
-                if (pixelHsvSaturation <= SATURATION_THRESHOLD &&
-                    pixelHsvValue > MIN_HSV_VALUE_FOR_WHITE) {
-                    saturationHistogram[pixelHsvSaturation]++;
-                }
-                if (pixelHsvValue > MIN_HSV_VALUE_NON_GRAY) {
-                    nrNonGrayPixels++;
-                }
+    void HistogramColorDetectorImpl::computeHistograms(const cv::Mat &image,
+                                                       int *saturationHistogram,
+                                                       int *hueHistogram,
+                                                       int &nrNonGrayPixels) const {
+        std::fill(saturationHistogram, saturationHistogram + SATURATION_HISTOGRAM_SIZE, 0);
+        std::fill(hueHistogram, hueHistogram + HUE_BUFFER_SIZE, 0);
+        nrNonGrayPixels = 0;
+
+        // Every pixel increments its bins by 0 or 1 instead of branching on the thresholds
+        auto countPixel = [&](const uchar *pixel) {
+            const uchar pixelHsvSaturation = pixel[1];
+            const uchar pixelHsvValue = pixel[2];
+            const int isNonGray = pixelHsvValue > MIN_HSV_VALUE_NON_GRAY;
+            hueHistogram[pixel[0]] += isNonGray;
+            saturationHistogram[pixelHsvSaturation] +=
+                    (pixelHsvSaturation <= SATURATION_THRESHOLD) & (pixelHsvValue > MIN_HSV_VALUE_FOR_WHITE);
+            nrNonGrayPixels += isNonGray;
+        };
+
+        for (int i = 0; i < image.rows; i++) {
+            const uchar *pixel = image.ptr<uchar>(i);
+            int j = 0;
+            for (; j + 4 <= image.cols; j += 4, pixel += 12) {
+                countPixel(pixel);
+                countPixel(pixel + 3);
+                countPixel(pixel + 6);
+                countPixel(pixel + 9);
+            }
+            for (; j < image.cols; j++, pixel += 3) {
+                countPixel(pixel);
             }
         }
     }
@@ -0,0 +1,20 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <opencv2/core/core.hpp>
+#include "../../../include/rubikdetector/detectors/colordetector/RubikColorDetector.hpp"
+
+namespace rbdt {
+
+    void RubikColorDetector::detectColors(const ImagePatches &patches,
+                                          const float whiteRatio,
+                                          std::vector<ColorDetection> &detections) {
+        detections.resize(patches.count);
+        for (int i = 0; i < patches.count; i++) {
+            detections[i].color = detectColor(patches.patch(i), whiteRatio, i);
+            detections[i].confidence = ColorDetection::UNKNOWN_CONFIDENCE;
+        }
+    }
+
+} //end namespace rbdt
@@ -18,14 +18,20 @@ namespace rbdt {
         LOG_DEBUG("RubikJniPart.cpp", "SimpleFaceletsDetector - destructor.");
     }
 
-    std::vector<std::vector<RubikFacelet>> SimpleFaceletsDetector::detect(cv::Mat &frameGray,
-                                                                          const std::string &tag,
-                                                                          const int frameNumber) {
+    FaceGrid SimpleFaceletsDetector::detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber) {
         return behavior->detect(frameGray, tag, frameNumber);
     }
 
+    FaceGrid SimpleFaceletsDetector::detectUntracked(cv::Mat &frameGray, const std::string &tag, const int frameNumber) {
+        return behavior->detectUntracked(frameGray, tag, frameNumber);
+    }
+
     void SimpleFaceletsDetector::onFrameSizeSelected(int dimension) {
         behavior->onFrameSizeSelected(dimension);
     }
 
+    void SimpleFaceletsDetector::setTrackingEnabled(bool enabled) {
+        behavior->setTrackingEnabled(enabled);
+    }
+
 } //end namespace rbdt
\ No newline at end of file
@@ -2,6 +2,7 @@
 //
 
 #include <math.h>
+#include <cmath>
 #include <opencv2/imgproc/types_c.h>
 #include "../../../include/rubikdetector/detectors/faceletsdetector/internal/SimpleFaceletsDetectorImpl.hpp"
 #include "../../../include/rubikdetector/detectors/faceletsdetector/SimpleFaceletsDetector.hpp"
@@ -9,6 +10,7 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include "../../../include/rubikdetector/utils/Utils.hpp"
 #include "../../../include/rubikdetector/utils/CrossLog.hpp"
+#include "../../../include/rubikdetector/utils/LatencyRecorder.hpp"
 
 namespace rbdt {
 
@@ -22,23 +24,67 @@ namespace rbdt {
 
     SimpleFaceletsDetectorImpl::SimpleFaceletsDetectorImpl(
             std::shared_ptr<ImageSaver> imageSaver) :
-            imageSaver(imageSaver) {
+            imageSaver(imageSaver),
+            trackingEnabled(true) {
     }
 
     SimpleFaceletsDetectorImpl::~SimpleFaceletsDetectorImpl() {
         LOG_DEBUG("RubikJniPart.cpp", "SimpleFaceletsDetectorBehavior - destructor.");
     }
 
-    std::vector<std::vector<RubikFacelet>>
-    SimpleFaceletsDetectorImpl::detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber) {
+    FaceGrid SimpleFaceletsDetectorImpl::detect(cv::Mat &frameGray, const std::string &tag, const int frameNumber) {
+        std::unique_ptr<DetectionScratch> scratch = acquireScratch();
+        FaceGrid faceGrid = detectWithScratch(frameGray, tag, frameNumber, trackingEnabled, *scratch);
+        releaseScratch(std::move(scratch));
+        return faceGrid;
+    }
+
+    FaceGrid SimpleFaceletsDetectorImpl::detectUntracked(cv::Mat &frameGray, const std::string &tag, const int frameNumber) {
+        std::unique_ptr<DetectionScratch> scratch = acquireScratch();
+        FaceGrid faceGrid = detectWithScratch(frameGray, tag, frameNumber, false, *scratch);
+        releaseScratch(std::move(scratch));
+        return faceGrid;
+    }
+
+    FaceGrid SimpleFaceletsDetectorImpl::detectWithScratch(cv::Mat &frameGray,
+                                                           const std::string &tag,
+                                                           const int frameNumber,
+                                                           const bool tracking,
+                                                           DetectionScratch &scratch) {
+
+        if (tracking) {
+            {
+                std::lock_guard<std::mutex> lock(trackingMutex);
+                std::map<std::string, std::vector<Circle>>::const_iterator trackedFace = trackedFaces.find(tag);
+                if (trackedFace != trackedFaces.end()) {
+                    scratch.previousFacelets = trackedFace->second;
+                } else {
+                    scratch.previousFacelets.clear();
+                }
+            }
+            if (!scratch.previousFacelets.empty() && trackFace(frameGray, scratch)) {
+                std::copy(scratch.trackedFacelets.begin(), scratch.trackedFacelets.end(), scratch.facetModel.begin());
+                FaceGrid faceGrid = createResult(scratch.facetModel, scratch.overlaps);
+                if (isInsideFrame(faceGrid, frameGray)) {
+                    updateTrackedFace(tag, scratch.trackedFacelets);
+                    LOG_DEBUG("RubikJniPart.cpp", "%s tracked", tag.c_str());
+                    return faceGrid;
+                }
+            }
+            LOG_VERBOSE("RubikJniPart.cpp", "%s lost, running the full detection", tag.c_str());
+        }
 
-        std::vector<std::vector<RubikFacelet>> facelets(0);
-        std::vector<std::vector<cv::Point>> contours = detectContours(frameGray);
-        std::vector<cv::RotatedRect> filteredRectangles;
-        std::vector<Circle> filteredRectanglesInnerCircles;
+        detectContours(frameGray, scratch.blurredFrame, scratch.contours, scratch.hierarchy);
+        std::vector<cv::RotatedRect> &filteredRectangles = scratch.filteredRectangles;
+        std::vector<Circle> &filteredRectanglesInnerCircles = scratch.innerCircles;
+        filteredRectangles.clear();
+        filteredRectanglesInnerCircles.clear();
 
         // Find rectangles, add inner circles to them
-        filterContours(contours, filteredRectangles, filteredRectanglesInnerCircles);
+        {
+            ScopedStageTimer timer(ProcessingStage::FILTER_CONTOURS);
+            filterContours(scratch.contours, filteredRectangles, filteredRectanglesInnerCircles);
+        }
 //        LOG_DEBUG("RubikJniPart.cpp", "SimpleFaceletsDetectorBehavior - after filter. Found %d inner circles.",
 //                  filteredRectanglesInnerCircles.size());
         /**/
@@ -50,58 +96,63 @@ namespace rbdt {
         // Test each one of those rectangles with inner circle (facelets)
         // potential facelets are those similar enough to the one being used as reference
         // estimated facelets are created based on the reference, a calculated margin and the estimated position of the reference
+        ScopedStageTimer gridMatchingTimer(ProcessingStage::GRID_MATCHING);
+        // Built once, so each reference only looks at the circles around it
+        scratch.innerCirclesIndex.build(filteredRectanglesInnerCircles, frameGray.size());
+        std::vector<Circle> &potentialFacelets = scratch.potentialFacelets;
+        std::vector<Circle> &estimatedFacelets = scratch.estimatedFacelets;
+        std::array<Circle, 9> &facetModel = scratch.facetModel;
+        FaceGrid faceGrid;
         bool faceFound = false;
         for (int i = 0; i < filteredRectanglesInnerCircles.size() && !faceFound; i++) {
-            Circle referenceCircle = filteredRectanglesInnerCircles[i];
+            const Circle &referenceCircle = filteredRectanglesInnerCircles[i];
             // Filter inner circles (facelets) similar enough to the reference inner circle (facelet)
-            std::vector<Circle> potentialFacelets = findPotentialFacelets(referenceCircle, filteredRectanglesInnerCircles, i);
+            findPotentialFacelets(referenceCircle, filteredRectanglesInnerCircles, scratch.innerCirclesIndex, i, scratch.neighbours,
+                                  potentialFacelets);
 
             if (potentialFacelets.size() < MIN_POTENTIAL_FACELETS_REQUIRED) {
-                LOG_DEBUG("RubikJniPart.cpp",
-                          "SimpleFaceletsDetectorBehavior - found: %d out of a minimum of %d potential facelets. Ignore #%d.",
-                          potentialFacelets.size(), MIN_POTENTIAL_FACELETS_REQUIRED, i);
+                LOG_VERBOSE("RubikJniPart.cpp",
+                            "SimpleFaceletsDetectorBehavior - found: %d out of a minimum of %d potential facelets. Ignore #%d.",
+                            potentialFacelets.size(), MIN_POTENTIAL_FACELETS_REQUIRED, i);
                 continue;
             }
 
+            scratch.potentialCandidates.assign(potentialFacelets);
             // Find the minimum distance between the circles
-            float margin = computeMargin(referenceCircle, potentialFacelets);
+            float margin = computeMargin(referenceCircle, scratch.potentialCandidates);
             // Guess the facelet position in the face
             int position = estimatePositionOfFacelet(referenceCircle, potentialFacelets);
             if (position == -1) {
-                LOG_DEBUG("RubikJniPart.cpp", "SimpleFaceletsDetectorBehavior - no valid position for the facelet. Ignore #%d.", i);
+                LOG_VERBOSE("RubikJniPart.cpp", "SimpleFaceletsDetectorBehavior - no valid position for the facelet. Ignore #%d.", i);
                 continue;
             }
             // Create estimated facelet positions as circles assuming reference circle as top left position with margin and same area
-            std::vector<Circle> estimatedFacelets = estimateRemainingFaceletsPositions(referenceCircle, margin, position);
+            estimateRemainingFaceletsPositions(referenceCircle, margin, position, estimatedFacelets);
 
             // Find those potential facelets that match the estimated ones
-            std::vector<std::vector<Circle>> facetModel = matchEstimatedWithPotentialFacelets(potentialFacelets, estimatedFacelets);
+            matchEstimatedWithPotentialFacelets(potentialFacelets, scratch.potentialCandidates, estimatedFacelets,
+                                                scratch.containingFacelets, facetModel, scratch.overlaps);
 //            saveDebugData(frameGray, filteredRectangles, referenceCircle, potentialFacelets, estimatedFacelets, frameNumber, tag);
             // Decide if the cube has been found depending on the matched facelets placement
             faceFound = verifyIfFaceFound(facetModel);
             if (faceFound) {
                 fillMissingFacelets(estimatedFacelets, facetModel);
-                facelets = createResult(facetModel);
+                faceGrid = createResult(facetModel, scratch.overlaps);
 
                 // This check used to be done on the color detection part for some reason..
-                for (int j = 0; j < 3; j++) {
-                    for (int k = 0; k < 3; k++) {
-                        RubikFacelet facelet = facelets[j][k];
-                        float innerCircleRadius = facelet.innerCircleRadius();
-                        if ((facelet.center.x - innerCircleRadius) < 0 ||
-                            (facelet.center.x + innerCircleRadius) > frameGray.cols ||
-                            (facelet.center.y - innerCircleRadius) < 0 ||
-                            (facelet.center.y + innerCircleRadius) > frameGray.rows ||
-                            innerCircleRadius < 0) {
-                            LOG_DEBUG("NativeRubikProcessor", "frameNumber: %d FOUND INVALID RECT AFTER FINDING FACE", frameNumber);
-                            facelets.clear();
-                            faceFound = false;
-                            break;
-                        }
-                    }
+                if (!isInsideFrame(faceGrid, frameGray)) {
+                    LOG_DEBUG("NativeRubikProcessor", "frameNumber: %d FOUND INVALID RECT AFTER FINDING FACE", frameNumber);
+                    faceGrid = FaceGrid();
+                    faceFound = false;
+                } else if (tracking) {
+                    scratch.trackedFacelets.assign(facetModel.begin(), facetModel.end());
+                    updateTrackedFace(tag, scratch.trackedFacelets);
                 }
             }
         }
+        if (!faceFound && tracking) {
+            updateTrackedFace(tag, std::vector<Circle>());
+        }
 
         if (faceFound) {
             LOG_DEBUG("RubikJniPart.cpp", "%s detected", tag.c_str());
@@ -109,22 +160,158 @@ namespace rbdt {
             LOG_DEBUG("RubikJniPart.cpp", "%s not detected", tag.c_str());
         }
 
-        return facelets;
+        return faceGrid;
     }
 
     void SimpleFaceletsDetectorImpl::onFrameSizeSelected(int dimension) {
-        minValidShapeArea = (int) (dimension * 2 * MIN_VALID_SHAPE_TO_IMAGE_AREA_RATIO);
+        // Everything measured in pixels was tuned on REFERENCE_DIMENSION sized faces
+        const float scale = (float) dimension / REFERENCE_DIMENSION;
+        minValidShapeArea = (int) (REFERENCE_DIMENSION * 2 * MIN_VALID_SHAPE_TO_IMAGE_AREA_RATIO * scale * scale);
+        circleDistanceBuffer = CIRCLE_DISTANCE_BUFFER * scale;
+        fallbackMargin = FALLBACK_MARGIN * scale;
+        blurKernelSize = std::max(3, (int) std::round(BLUR_KERNEL_SIZE * scale) | 1);
+        // OpenCV only has 3x3, 5x5 & 7x7 Sobel kernels for Canny. Their gains differ, so the thresholds follow the kernel
+        cannyApertureSize = std::min(CANNY_APERTURE_SIZE, std::max(3, (int) std::round(CANNY_APERTURE_SIZE * scale) | 1));
+        cannyLowThreshold = CANNY_LOW_THRESHOLD * sobelGain(cannyApertureSize) / sobelGain(CANNY_APERTURE_SIZE);
+        // The grids found so far are in the coordinates of the old frame size
+        std::lock_guard<std::mutex> lock(trackingMutex);
+        trackedFaces.clear();
+    }
+
+    void SimpleFaceletsDetectorImpl::setTrackingEnabled(bool enabled) {
+        trackingEnabled = enabled;
+        if (!enabled) {
+            std::lock_guard<std::mutex> lock(trackingMutex);
+            trackedFaces.clear();
+        }
     }
 
-    std::vector<std::vector<cv::Point>> SimpleFaceletsDetectorImpl::detectContours(const cv::Mat &frameGray) const {
+    std::unique_ptr<SimpleFaceletsDetectorImpl::DetectionScratch> SimpleFaceletsDetectorImpl::acquireScratch() {
+        {
+            std::lock_guard<std::mutex> lock(scratchMutex);
+            if (!freeScratches.empty()) {
+                std::unique_ptr<DetectionScratch> scratch = std::move(freeScratches.back());
+                freeScratches.pop_back();
+                return scratch;
+            }
+        }
+        // Only happens while warming up, or when more faces than ever before are detected at the same time
+        return std::unique_ptr<DetectionScratch>(new DetectionScratch());
+    }
+
+    void SimpleFaceletsDetectorImpl::releaseScratch(std::unique_ptr<DetectionScratch> scratch) {
+        std::lock_guard<std::mutex> lock(scratchMutex);
+        freeScratches.push_back(std::move(scratch));
+    }
+
+    bool SimpleFaceletsDetectorImpl::trackFace(const cv::Mat &frameGray, DetectionScratch &scratch) const {
+        ScopedStageTimer timer(ProcessingStage::FACE_TRACKING);
+        const std::vector<Circle> &previousFacelets = scratch.previousFacelets;
+
+        // Search region: the previous grid, grown by the distance the cube is allowed to move between two frames
+        float minX = frameGray.cols;
+        float minY = frameGray.rows;
+        float maxX = 0;
+        float maxY = 0;
+        for (const Circle &facelet : previousFacelets) {
+            float halfSize = std::max(facelet.originalRectWidth, facelet.originalRectHeight) * (0.5f + TRACKING_SEARCH_MARGIN);
+            minX = std::min(minX, facelet.center.x - halfSize);
+            minY = std::min(minY, facelet.center.y - halfSize);
+            maxX = std::max(maxX, facelet.center.x + halfSize);
+            maxY = std::max(maxY, facelet.center.y + halfSize);
+        }
+        cv::Rect region = cv::Rect(cv::Point((int) std::floor(minX), (int) std::floor(minY)),
+                                   cv::Point((int) std::ceil(maxX), (int) std::ceil(maxY))) &
+                          cv::Rect(0, 0, frameGray.cols, frameGray.rows);
+        if (region.area() == 0) {
+            return false;
+        }
+
+        // Same steps as detectContours(), but restricted to the region. The edges go to the top left corner of a frame
+        // sized buffer, so the region can change size without reallocating it
+        scratch.trackingEdges.create(frameGray.size(), CV_8UC1);
+        cv::Mat regionEdges = scratch.trackingEdges(cv::Rect(0, 0, region.width, region.height));
+        cv::blur(frameGray(region), regionEdges, cv::Size(blurKernelSize, blurKernelSize));
+        cv::Canny(regionEdges, regionEdges, cannyLowThreshold, cannyLowThreshold * CANNY_THRESHOLD_RATIO, cannyApertureSize, true);
+        cv::findContours(regionEdges, scratch.contours, scratch.hierarchy, CV_RETR_LIST, CV_CHAIN_APPROX_SIMPLE, region.tl());
+
+        scratch.filteredRectangles.clear();
+        scratch.innerCircles.clear();
+        filterContours(scratch.contours, scratch.filteredRectangles, scratch.innerCircles);
+
+        scratch.potentialCandidates.assign(scratch.innerCircles);
+        std::array<Circle, 9> &facetModel = scratch.facetModel;
+        matchEstimatedWithPotentialFacelets(scratch.innerCircles, scratch.potentialCandidates, previousFacelets,
+                                            scratch.containingFacelets, facetModel, scratch.overlaps);
+        if (!verifyIfFaceFound(facetModel)) {
+            return false;
+        }
+
+        // Move the facelets which weren't matched by the average displacement of the ones which were
+        cv::Point2f displacement(0, 0);
+        int matchedCount = 0;
+        for (int i = 0; i < 9; i++) {
+            const Circle &matched = facetModel[i];
+            if (!matched.isEmpty()) {
+                displacement.x += matched.center.x - previousFacelets[i].center.x;
+                displacement.y += matched.center.y - previousFacelets[i].center.y;
+                matchedCount++;
+            }
+        }
+        displacement.x /= matchedCount;
+        displacement.y /= matchedCount;
+        std::vector<Circle> &trackedFacelets = scratch.trackedFacelets;
+        trackedFacelets.clear();
+        for (int i = 0; i < 9; i++) {
+            const Circle &matched = facetModel[i];
+            trackedFacelets.push_back(matched.isEmpty() ? Circle(previousFacelets[i], displacement) : matched);
+        }
+        return true;
+    }
+
+    void SimpleFaceletsDetectorImpl::updateTrackedFace(const std::string &tag, const std::vector<Circle> &facelets) {
+        std::lock_guard<std::mutex> lock(trackingMutex);
+        if (facelets.empty()) {
+            // Cleared rather than erased, so the next grid found for the tag reuses the storage
+            std::map<std::string, std::vector<Circle>>::iterator trackedFace = trackedFaces.find(tag);
+            if (trackedFace != trackedFaces.end()) {
+                trackedFace->second.clear();
+            }
+        } else {
+            trackedFaces[tag] = facelets;
+        }
+    }
+
+    bool SimpleFaceletsDetectorImpl::isInsideFrame(const FaceGrid &faceGrid, const cv::Mat &frameGray) const {
+        for (const RubikFacelet &facelet : faceGrid.facelets) {
+            float innerCircleRadius = facelet.innerCircleRadius();
+            if ((facelet.center.x - innerCircleRadius) < 0 ||
+                (facelet.center.x + innerCircleRadius) > frameGray.cols ||
+                (facelet.center.y - innerCircleRadius) < 0 ||
+                (facelet.center.y + innerCircleRadius) > frameGray.rows ||
+                innerCircleRadius < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void SimpleFaceletsDetectorImpl::detectContours(cv::Mat &frameGray,
+                                                    cv::Mat &blurredFrame,
+                                                    std::vector<std::vector<cv::Point>> &contours,
+                                                    std::vector<cv::Vec4i> &hierarchy) const {
         /// Reduce noise with a kernel
-        cv::blur(frameGray, frameGray, cv::Size(BLUR_KERNEL_SIZE, BLUR_KERNEL_SIZE));
+        {
+            ScopedStageTimer timer(ProcessingStage::BLUR);
+            cv::blur(frameGray, blurredFrame, cv::Size(blurKernelSize, blurKernelSize));
+        }
         // Canny detector
-        cv::Canny(frameGray, frameGray, CANNY_LOW_THRESHOLD, CANNY_LOW_THRESHOLD * CANNY_THRESHOLD_RATIO, CANNY_APERTURE_SIZE, true);
-        std::vector<cv::Vec4i> hierarchy;
-        std::vector<std::vector<cv::Point> > contours;
+        {
+            ScopedStageTimer timer(ProcessingStage::CANNY);
+            cv::Canny(blurredFrame, frameGray, cannyLowThreshold, cannyLowThreshold * CANNY_THRESHOLD_RATIO, cannyApertureSize, true);
+        }
+        ScopedStageTimer timer(ProcessingStage::FIND_CONTOURS);
         cv::findContours(frameGray, contours, hierarchy, CV_RETR_LIST, CV_CHAIN_APPROX_SIMPLE, cv::Point(0, 0));
-        return contours;
     }
 
     //TODO: potential improvement, remove rectangles that are too similar
@@ -149,38 +336,29 @@ namespace rbdt {
         }
     }
 
-    float SimpleFaceletsDetectorImpl::computeMargin(Circle referenceCircle, std::vector<Circle> validCircles) {
-        float margin = 320.0f;
-        for (int i = 0; i < validCircles.size(); i++) {
-            Circle testedCircle = validCircles[i];
-            if (referenceCircle.contains(testedCircle.center) ||
-                (testedCircle.center.x >
-                 referenceCircle.center.x + 3 * referenceCircle.radius + CIRCLE_DISTANCE_BUFFER) ||
-                (testedCircle.center.y >
-                 referenceCircle.center.y + 3 * referenceCircle.radius + CIRCLE_DISTANCE_BUFFER)) {
-                //if the center of the current rectangle/circle is  within the current reference, or is either too far from
-                //the current rectangle (either to the left or to the right), then just skip it
-                continue;
-            }
-            float currentMargin =
-                    rbdt::pointsDistance(referenceCircle.center, testedCircle.center) -
-                    referenceCircle.radius - testedCircle.radius;
-            if (currentMargin < margin && currentMargin > 0) {
-                margin = currentMargin;
-            }
-        }
+    float SimpleFaceletsDetectorImpl::computeMargin(const Circle &referenceCircle, const CircleCandidates &validCircles) const {
+        //circles whose center is within the current reference, or too far from it (either to the right or below), are skipped
+        // Gaps as wide as the radius are rejected anyway, so the radius bounds the search instead of a fixed number of pixels
+        float margin = validCircles.findSmallestGap(referenceCircle, 3 * referenceCircle.radius + circleDistanceBuffer,
+                                                    referenceCircle.radius);
+
+        return margin >= referenceCircle.radius ? fallbackMargin : margin;
+    }
 
-        return (margin >= 320.0f || margin >= referenceCircle.radius) ? 10.f : margin;
+    float SimpleFaceletsDetectorImpl::sobelGain(int apertureSize) {
+        // Response of the Sobel derivative kernel to a unit slope: 8 for 3x3, 128 for 5x5, 2048 for 7x7
+        return (float) (1 << (2 * apertureSize - 3));
     }
 
-    int SimpleFaceletsDetectorImpl::estimatePositionOfFacelet(Circle referenceCircle, std::vector<Circle> validCircles) {
+    int SimpleFaceletsDetectorImpl::estimatePositionOfFacelet(const Circle &referenceCircle,
+                                                              const std::vector<Circle> &validCircles) const {
         // top row facelets are 0, 1 and 2, middle row 3, 4 and 5, bottom row 6, 7 and 8 from left to right
         bool hasFaceletsToTheRight = false;
         bool hasFaceletsToTheLeft = false;
         bool hasFaceletsDown = false;
         bool hasFaceletsUp = false;
         for (int i = 0; i < validCircles.size(); i++) {
-            Circle testedCircle = validCircles[i];
+            const Circle &testedCircle = validCircles[i];
             if (!hasFaceletsToTheRight && testedCircle.center.x > referenceCircle.center.x + referenceCircle.radius) {
                 hasFaceletsToTheRight = true;
             }
@@ -221,35 +399,40 @@ namespace rbdt {
         }
     }
 
-    std::vector<Circle> SimpleFaceletsDetectorImpl::findPotentialFacelets(
+    void SimpleFaceletsDetectorImpl::findPotentialFacelets(
             const Circle &referenceCircle,
             const std::vector<Circle> &innerCircles,
-            int referenceCircleIndex) const {
+            const CircleGridIndex &innerCirclesIndex,
+            int referenceCircleIndex,
+            std::vector<int> &neighbours,
+            std::vector<Circle> &foundCircles) const {
 
         //only have rectangles that have an area & orientation similar to the initial one
-        std::vector<Circle> foundCircles;
-        for (int j = 0; j < innerCircles.size(); j++) {
-            if (referenceCircleIndex == j) {
-                continue;
-            }
-            Circle testedCircle = innerCircles[j];
-            float maxArea = (float) std::max(referenceCircle.area, testedCircle.area);
-            int minArea = std::min(referenceCircle.area, testedCircle.area);
-            float ratio = maxArea / minArea;
-            float angleDifference = (float) std::abs((referenceCircle.angle - testedCircle.angle) * 180 / CV_PI);
-            if (ratio < 1.5f && angleDifference < 35.0f) {
-                foundCircles.push_back(testedCircle);
+        innerCirclesIndex.findSimilarInRadius(referenceCircle, computeFaceReach(referenceCircle), MAX_POTENTIAL_FACELET_AREA_RATIO,
+                                              MAX_POTENTIAL_FACELET_ANGLE_DIFFERENCE, neighbours);
+        foundCircles.clear();
+        for (int j : neighbours) {
+            if (referenceCircleIndex != j) {
+                foundCircles.push_back(innerCircles[j]);
             }
         }
-        return foundCircles;
     }
 
-    std::vector<Circle> SimpleFaceletsDetectorImpl::estimateRemainingFaceletsPositions(
+    float SimpleFaceletsDetectorImpl::computeFaceReach(const Circle &referenceCircle) const {
+        float largestMargin = std::max(referenceCircle.radius, fallbackMargin);
+        float largestStep = referenceCircle.radius * 2 + largestMargin;
+        // Radius ratio matching the 1.5 area ratio accepted by findPotentialFacelets()
+        float largestMatchedRadius = referenceCircle.radius * 1.2248f;
+        return (float) M_SQRT2 * (2 * largestStep + largestMatchedRadius);
+    }
+
+    void SimpleFaceletsDetectorImpl::estimateRemainingFaceletsPositions(
             const Circle &referenceCircle,
             float margin,
-            int position) const {
+            int position,
+            std::vector<Circle> &newCircles) const {
         //draw the remaining rectangles
-        std::vector<Circle> newCircles;
+        newCircles.clear();
         float diameterWithMargin = referenceCircle.radius * 2 + margin;
 
         float angle = referenceCircle.angle;
@@ -265,53 +448,49 @@ namespace rbdt {
             float yOffset = yOffsetColumn * (i % 3 - position % 3) + yOffsetRow * (i / 3 - position / 3);
             newCircles.emplace_back(referenceCircle, cv::Point2f(xOffset, yOffset));
         }
-
-        return newCircles;
     }
 
-    std::vector<std::vector<Circle>> SimpleFaceletsDetectorImpl::matchEstimatedWithPotentialFacelets(
+    void SimpleFaceletsDetectorImpl::matchEstimatedWithPotentialFacelets(
             const std::vector<Circle> &potentialFacelets,
-            const std::vector<Circle> &estimatedFacelets) {
-
-        std::vector<std::vector<Circle>> facetModel(3, std::vector<Circle>(3));
+            const CircleCandidates &potentialCandidates,
+            const std::vector<Circle> &estimatedFacelets,
+            std::vector<int> &containingFacelets,
+            std::array<Circle, 9> &facetModel,
+            std::array<float, 9> &overlaps) const {
 
         // for each one of the estimated facelets try to find a potential facelet whose overlaps enough
         for (int i = 0; i < 9; i++) {
-            Circle testedCircle = estimatedFacelets[i];
-            for (int j = 0; j < potentialFacelets.size(); j++) {
-                if (potentialFacelets[j].contains(testedCircle.center)) {
-
-                    float R = std::max(testedCircle.radius, potentialFacelets[j].radius);
-                    float r = std::min(testedCircle.radius, potentialFacelets[j].radius);
-                    float d = rbdt::pointsDistance(testedCircle.center, potentialFacelets[j].center);
-
-                    float part1 = r * r * std::acos((d * d + r * r - R * R) / (2 * d * r));
-                    float part2 = R * R * std::acos((d * d + R * R - r * r) / (2 * d * R));
-                    float part3 = 0.5f * std::sqrt((-d + r + R) * (d + r - R) * (d - r + R) * (d + r + R));
-                    float intersectionArea = part1 + part2 - part3;
-
-                    float areasRatio = intersectionArea / potentialFacelets[j].area;
-                    if (areasRatio > 0.55f) {
-                        // found it
-                        int auxI = (i) / 3;
-                        int auxJ = (i) % 3;
-                        facetModel[auxI][auxJ] = potentialFacelets[j];
-                        //already found a matching rectangle, we are not interested in others. just continue
-                        continue;
-                    }
+            const Circle &testedCircle = estimatedFacelets[i];
+            facetModel[i] = Circle();
+            overlaps[i] = 0;
+            potentialCandidates.findContaining(testedCircle.center, containingFacelets);
+            for (int j : containingFacelets) {
+                float R = std::max(testedCircle.radius, potentialFacelets[j].radius);
+                float r = std::min(testedCircle.radius, potentialFacelets[j].radius);
+                float d = rbdt::pointsDistance(testedCircle.center, potentialFacelets[j].center);
+
+                float part1 = r * r * std::acos((d * d + r * r - R * R) / (2 * d * r));
+                float part2 = R * R * std::acos((d * d + R * R - r * r) / (2 * d * R));
+                float part3 = 0.5f * std::sqrt((-d + r + R) * (d + r - R) * (d - r + R) * (d + r + R));
+                float intersectionArea = part1 + part2 - part3;
+
+                float areasRatio = intersectionArea / potentialFacelets[j].area;
+                if (areasRatio > 0.55f) {
+                    // found it
+                    facetModel[i] = potentialFacelets[j];
+                    overlaps[i] = std::min(areasRatio, 1.0f);
+                    //already found a matching rectangle, we are not interested in others. just continue
+                    continue;
                 }
             }
         }
-        return facetModel;
     }
 
-    bool SimpleFaceletsDetectorImpl::verifyIfFaceFound(const std::vector<std::vector<Circle>> &cubeFacet) const {
+    bool SimpleFaceletsDetectorImpl::verifyIfFaceFound(const std::array<Circle, 9> &cubeFacet) const {
         int faceletsCount = 0;
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                if (!cubeFacet[i][j].isEmpty()) {
-                    faceletsCount++;
-                }
+        for (const Circle &facelet : cubeFacet) {
+            if (!facelet.isEmpty()) {
+                faceletsCount++;
             }
         }
         return faceletsCount > 4;
@@ -319,28 +498,24 @@ namespace rbdt {
 
     void SimpleFaceletsDetectorImpl::fillMissingFacelets(
             const std::vector<Circle> &estimatedFacelets,
-            std::vector<std::vector<Circle>> &facetModel) {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                if (facetModel[i][j].isEmpty()) {
-                    facetModel[i][j] = estimatedFacelets[i * 3 + j];
-                }
+            std::array<Circle, 9> &facetModel) const {
+        for (int i = 0; i < 9; i++) {
+            if (facetModel[i].isEmpty()) {
+                facetModel[i] = estimatedFacelets[i];
             }
         }
     }
 
-    std::vector<std::vector<RubikFacelet>> SimpleFaceletsDetectorImpl::createResult(
-            const std::vector<std::vector<Circle>> &faceModel) {
-
-        std::vector<std::vector<RubikFacelet>> result(3, std::vector<RubikFacelet>(3));
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                result[i][j] = RubikFacelet(Point2d(faceModel[i][j].center.x,
-                                                    faceModel[i][j].center.y),
-                                            faceModel[i][j].originalRectWidth,
-                                            faceModel[i][j].originalRectHeight,
-                                            faceModel[i][j].angle);
-            }
+    FaceGrid SimpleFaceletsDetectorImpl::createResult(const std::array<Circle, 9> &faceModel,
+                                                      const std::array<float, 9> &overlaps) const {
+        FaceGrid result;
+        result.found = true;
+        for (int i = 0; i < FaceGrid::FACELET_COUNT; i++) {
+            result.facelets[i] = RubikFacelet(Point2d(faceModel[i].center.x, faceModel[i].center.y),
+                                              faceModel[i].originalRectWidth,
+                                              faceModel[i].originalRectHeight,
+                                              faceModel[i].angle);
+            result.confidence[i] = overlaps[i];
         }
         return result;
     }
@@ -370,10 +545,10 @@ namespace rbdt {
                                                    const std::vector<Circle> &potentialFacelets,
                                                    const std::vector<Circle> &estimatedFacelets,
                                                    const int frameNumber,
-                                                   const std::string &tag) {
+                                                   const std::string &tag) const {
 //        LOG_DEBUG("RUBIK_JNI_PART.cpp", "SimpleFaceletsDetectorBehavior - savingDebugData. imageSaver!=null: %d", imageSaver != nullptr);
         ///BEGIN PRINT
-        if (imageSaver != nullptr) {
+        if (isSavingImages(imageSaver)) {
             ///save whole frame
             saveWholeFrame(frame, frameNumber * 10, tag);
 
@@ -397,8 +572,14 @@ namespace rbdt {
             ///save potential & estimated facelets which match
             ///recompute the incomplete facelet model, in order to print only the facelets which passed through all the filtering steps
             ///it's a waste indeed to compute them once more...but then again, this is for debugging so..
-            std::vector<std::vector<Circle>> faceletIncompleteModel = matchEstimatedWithPotentialFacelets(potentialFacelets,
-                                                                                                          estimatedFacelets);
+            CircleCandidates potentialCandidates;
+            potentialCandidates.assign(potentialFacelets);
+            std::vector<int> containingFacelets;
+            std::array<Circle, 9> matchedFacelets;
+            std::array<float, 9> overlaps;
+            matchEstimatedWithPotentialFacelets(potentialFacelets, potentialCandidates, estimatedFacelets, containingFacelets,
+                                                matchedFacelets, overlaps);
+            std::vector<Circle> faceletIncompleteModel(matchedFacelets.begin(), matchedFacelets.end());
 
             drawing = cv::Mat::zeros(frame.size(), CV_8UC3);
             drawFilteredRectangles(drawing, filteredRectangles);
@@ -0,0 +1,66 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include "../../include/rubikdetector/imagesaver/internal/AsyncImageWriter.hpp"
+#include "../../include/rubikdetector/utils/CrossLog.hpp"
+
+namespace rbdt {
+
+    AsyncImageWriter::AsyncImageWriter(int capacity, Encoder encoder) :
+            encoder(std::move(encoder)),
+            pendingImages(static_cast<size_t>(capacity)) {
+        writerThread = std::thread(&AsyncImageWriter::writerLoop, this);
+    }
+
+    AsyncImageWriter::~AsyncImageWriter() {
+        pendingImages.close();
+        writerThread.join();
+        if (droppedCount > 0) {
+            LOG_DEBUG("RubikJniPart.cpp", "AsyncImageWriter - dropped %d images.", droppedCount);
+        }
+    }
+
+    bool AsyncImageWriter::enqueue(const std::string &filePath, const cv::Mat &mat) {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingCount++;
+        }
+        PendingImage dropped;
+        if (pendingImages.pushDroppingOldest(PendingImage{filePath, mat.clone()}, dropped)) {
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                droppedCount++;
+            }
+            onImageDone();
+            return false;
+        }
+        return true;
+    }
+
+    void AsyncImageWriter::flush() {
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        allWritten.wait(lock, [this]() { return pendingCount == 0; });
+    }
+
+    void AsyncImageWriter::writerLoop() {
+        PendingImage image;
+        while (pendingImages.pop(image)) {
+            if (!encoder(image.filePath, image.mat)) {
+                LOG_DEBUG("RubikJniPart.cpp", "Couldn't save image");
+            }
+            // Release the copy before waiting for the next one
+            image.mat.release();
+            onImageDone();
+        }
+    }
+
+    void AsyncImageWriter::onImageDone() {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingCount--;
+        }
+        allWritten.notify_all();
+    }
+
+} //namespace rbdt
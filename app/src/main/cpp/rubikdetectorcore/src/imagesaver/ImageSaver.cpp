@@ -2,20 +2,48 @@
 // Created by catalin on 31.07.2017.
 //
 
+#include <fstream>
 #include <sstream>
 #include <opencv2/highgui/highgui.hpp>
 #include "../../include/rubikdetector/imagesaver/ImageSaver.hpp"
+#include "../../include/rubikdetector/imagesaver/internal/AsyncImageWriter.hpp"
 #include "../../include/rubikdetector/utils/CrossLog.hpp"
 
 namespace rbdt {
 
-    ImageSaver::ImageSaver(const std::string saveLocation) : path(saveLocation) {}
+    ImageSaver::ImageSaver() : enabled(false), format(Format::JPEG) {}
+
+    ImageSaver::ImageSaver(const std::string saveLocation, const Format format, const int queueCapacity) :
+            enabled(true),
+            path(saveLocation),
+            format(format) {
+        if (queueCapacity > 0) {
+            asyncWriter = std::unique_ptr<AsyncImageWriter>(new AsyncImageWriter(
+                    queueCapacity,
+                    [format](const std::string &filePath, const cv::Mat &mat) {
+                        return ImageSaver::encode(filePath, mat, format);
+                    }));
+        }
+    }
 
     ImageSaver::~ImageSaver() {
         LOG_DEBUG("RubikJniPart.cpp", "ImageSaver - destructor.");
     }
 
+    bool ImageSaver::isEnabled() const {
+        return enabled;
+    }
+
+    void ImageSaver::flush() {
+        if (asyncWriter != nullptr) {
+            asyncWriter->flush();
+        }
+    }
+
     bool ImageSaver::saveImage(const cv::Mat &mat, const int frameNumber, const int regionId) {
+        if (!enabled) {
+            return false;
+        }
         std::stringstream regionIdStringStream;
         regionIdStringStream << regionId;
         return saveImage(mat, frameNumber, regionIdStringStream.str());
@@ -24,14 +52,101 @@ namespace rbdt {
     bool ImageSaver::saveImage(const cv::Mat &mat,
                                const int frameNumber,
                                const std::string regionName) {
+        if (!enabled) {
+            return false;
+        }
         std::stringstream frameNrStringStream;
         frameNrStringStream << frameNumber;
-        std::string store_path = path + "/pic_" + frameNrStringStream.str() + "_" + regionName + ".jpg";
-        bool writeResult = cv::imwrite(store_path, mat);
+        std::string store_path = path + "/pic_" + frameNrStringStream.str() + "_" + regionName + fileExtension(format);
+        if (asyncWriter != nullptr) {
+            return asyncWriter->enqueue(store_path, mat);
+        }
+        bool writeResult = encode(store_path, mat, format);
         if (!writeResult) {
             LOG_DEBUG("RubikJniPart.cpp", "Couldn't save image");
         }
         return writeResult;
     }
 
-} //end namespace rbdt
\ No newline at end of file
+    const char *ImageSaver::fileExtension(const Format format) {
+        switch (format) {
+            case Format::PNG:
+                return ".png";
+            case Format::NPY:
+                return ".npy";
+            case Format::JPEG:
+            default:
+                return ".jpg";
+        }
+    }
+
+    bool ImageSaver::encode(const std::string &filePath, const cv::Mat &mat, const Format format) {
+        if (format == Format::NPY) {
+            return writeNpy(filePath, mat);
+        }
+        // cv::imwrite picks the encoder from the extension
+        return cv::imwrite(filePath, mat);
+    }
+
+    bool ImageSaver::writeNpy(const std::string &filePath, const cv::Mat &mat) {
+        const char *descr;
+        switch (mat.depth()) {
+            case CV_8U:
+                descr = "|u1";
+                break;
+            case CV_8S:
+                descr = "|i1";
+                break;
+            case CV_16U:
+                descr = "<u2";
+                break;
+            case CV_16S:
+                descr = "<i2";
+                break;
+            case CV_32S:
+                descr = "<i4";
+                break;
+            case CV_32F:
+                descr = "<f4";
+                break;
+            case CV_64F:
+                descr = "<f8";
+                break;
+            default:
+                return false;
+        }
+
+        std::stringstream header;
+        header << "{'descr': '" << descr << "', 'fortran_order': False, 'shape': (" << mat.rows << ", " << mat.cols << ", "
+               << mat.channels() << "), }";
+        // Magic string, version 1.0, header length, then the header padded with spaces & ended by a newline, so that the data
+        // starts at a multiple of 64 bytes
+        const size_t preambleLength = 10;
+        size_t headerLength = header.str().size() + 1;
+        size_t padding = (64 - (preambleLength + headerLength) % 64) % 64;
+        std::string headerString = header.str() + std::string(padding, ' ') + "\n";
+
+        std::ofstream file(filePath.c_str(), std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        const char magic[] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+        file.write(magic, sizeof(magic));
+        const unsigned char headerSize[] = {static_cast<unsigned char>(headerString.size() & 0xFF),
+                                            static_cast<unsigned char>((headerString.size() >> 8) & 0xFF)};
+        file.write(reinterpret_cast<const char *>(headerSize), sizeof(headerSize));
+        file.write(headerString.data(), headerString.size());
+
+        // Rows might not be contiguous, e.g. for a ROI
+        const size_t rowByteCount = mat.cols * mat.elemSize();
+        for (int row = 0; row < mat.rows; row++) {
+            file.write(reinterpret_cast<const char *>(mat.ptr(row)), rowByteCount);
+        }
+        return file.good();
+    }
+
+    bool isSavingImages(const std::shared_ptr<ImageSaver> &imageSaver) {
+        return imageSaver != nullptr && imageSaver->isEnabled();
+    }
+
+} //end namespace rbdt
@@ -0,0 +1,114 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../include/rubikdetector/recording/FrameRecordingReader.hpp"
+
+namespace rbdt {
+
+    FrameRecordingReader::FrameRecordingReader() :
+            mapping(nullptr),
+            mappingByteCount(0),
+            header(nullptr),
+            index(nullptr) {}
+
+    FrameRecordingReader::~FrameRecordingReader() {
+        close();
+    }
+
+    bool FrameRecordingReader::open(const std::string &path, std::string &error) {
+        close();
+        int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+        if (fileDescriptor == -1) {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat fileStat;
+        if (fstat(fileDescriptor, &fileStat) != 0 || static_cast<uint64_t>(fileStat.st_size) < sizeof(FrameRecordingHeader)) {
+            ::close(fileDescriptor);
+            error = path + " is not a frame recording";
+            return false;
+        }
+        const size_t byteCount = static_cast<size_t>(fileStat.st_size);
+        void *address = mmap(nullptr, byteCount, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fileDescriptor);
+        if (address == MAP_FAILED) {
+            error = "cannot map " + path;
+            return false;
+        }
+        // Frames are mostly replayed in recording order
+        madvise(address, byteCount, MADV_SEQUENTIAL);
+        mapping = static_cast<const uint8_t *>(address);
+        mappingByteCount = byteCount;
+
+        const FrameRecordingHeader *recordingHeader = reinterpret_cast<const FrameRecordingHeader *>(mapping);
+        if (std::memcmp(recordingHeader->magic, FRAME_RECORDING_MAGIC, sizeof(FRAME_RECORDING_MAGIC)) != 0 ||
+            recordingHeader->version != FRAME_RECORDING_VERSION) {
+            close();
+            error = path + " is not a frame recording, or was written by a different version";
+            return false;
+        }
+        const uint64_t indexByteCount = static_cast<uint64_t>(recordingHeader->frameCount) * sizeof(FrameRecordingIndexEntry);
+        if (recordingHeader->indexOffset == 0 || recordingHeader->indexOffset % FRAME_RECORDING_ALIGNMENT != 0 ||
+            recordingHeader->indexOffset > byteCount || indexByteCount > byteCount - recordingHeader->indexOffset) {
+            close();
+            error = path + " was not finished, or is truncated";
+            return false;
+        }
+        const FrameRecordingIndexEntry *recordingIndex =
+                reinterpret_cast<const FrameRecordingIndexEntry *>(mapping + recordingHeader->indexOffset);
+        for (uint32_t i = 0; i < recordingHeader->frameCount; i++) {
+            const FrameRecordingIndexEntry &entry = recordingIndex[i];
+            if (entry.role > static_cast<uint32_t>(FrameRole::PHOTO) || entry.offset < sizeof(FrameRecordingHeader) ||
+                entry.offset > recordingHeader->indexOffset || entry.byteCount > recordingHeader->indexOffset - entry.offset) {
+                close();
+                error = path + " has an invalid index entry for frame " + std::to_string(i);
+                return false;
+            }
+        }
+        header = recordingHeader;
+        index = recordingIndex;
+        return true;
+    }
+
+    void FrameRecordingReader::close() {
+        if (mapping != nullptr) {
+            munmap(const_cast<uint8_t *>(mapping), mappingByteCount);
+        }
+        mapping = nullptr;
+        mappingByteCount = 0;
+        header = nullptr;
+        index = nullptr;
+    }
+
+    int FrameRecordingReader::getFrameCount() const {
+        return header != nullptr ? static_cast<int>(header->frameCount) : 0;
+    }
+
+    FrameRecordingReader::Frame FrameRecordingReader::getFrame(const int frameIndex) const {
+        const FrameRecordingIndexEntry &entry = index[frameIndex];
+        Frame frame;
+        frame.role = static_cast<FrameRole>(entry.role);
+        frame.frameNumber = entry.frameNumber;
+        frame.data = mapping + entry.offset;
+        frame.byteCount = static_cast<size_t>(entry.byteCount);
+        return frame;
+    }
+
+    ImageProperties FrameRecordingReader::getImageProperties(const FrameRole role) const {
+        if (header == nullptr) {
+            return ImageProperties(0, 0, 0);
+        }
+        if (role == FrameRole::SCAN) {
+            return ImageProperties(header->scanRotation, header->scanWidth, header->scanHeight);
+        }
+        return ImageProperties(header->photoRotation, header->photoWidth, header->photoHeight);
+    }
+
+} //end namespace rbdt
@@ -0,0 +1,119 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../../include/rubikdetector/recording/FrameRecordingWriter.hpp"
+#include "../../include/rubikdetector/data/config/ImageProperties.hpp"
+#include "../../include/rubikdetector/utils/CrossLog.hpp"
+
+namespace rbdt {
+
+    FrameRecordingWriter::FrameRecordingWriter() :
+            fileDescriptor(-1),
+            scanFrameByteCount(0),
+            photoFrameByteCount(0),
+            nextFrameOffset(0),
+            header() {}
+
+    FrameRecordingWriter::~FrameRecordingWriter() {
+        finish();
+    }
+
+    bool FrameRecordingWriter::open(const std::string &path, const ImageProperties &scanProperties,
+                                    const ImageProperties &photoProperties) {
+        finish();
+        fileDescriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor == -1) {
+            LOG_WARN("FrameRecordingWriter", "Cannot create the recording %s.", path.c_str());
+            return false;
+        }
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, FRAME_RECORDING_MAGIC, sizeof(header.magic));
+        header.version = FRAME_RECORDING_VERSION;
+        header.scanWidth = scanProperties.width;
+        header.scanHeight = scanProperties.height;
+        header.scanRotation = scanProperties.rotation;
+        header.photoWidth = photoProperties.width;
+        header.photoHeight = photoProperties.height;
+        header.photoRotation = photoProperties.rotation;
+        scanFrameByteCount = static_cast<uint64_t>(scanProperties.width) * (scanProperties.height + scanProperties.height / 2);
+        photoFrameByteCount = static_cast<uint64_t>(photoProperties.width) * (photoProperties.height + photoProperties.height / 2);
+        nextFrameOffset = sizeof(FrameRecordingHeader);
+        index.clear();
+
+        // Written again by finish(), with the index offset. Until then the recording is marked as unfinished
+        if (!writeAt(0, &header, sizeof(header))) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool FrameRecordingWriter::append(const FrameRole role, const int frameNumber, const uint8_t *data) {
+        if (!isOpen()) {
+            return false;
+        }
+        const uint64_t byteCount = role == FrameRole::SCAN ? scanFrameByteCount : photoFrameByteCount;
+        if (!writeAt(nextFrameOffset, data, byteCount)) {
+            LOG_WARN("FrameRecordingWriter", "Failed to append frame %d, closing the recording.", frameNumber);
+            close();
+            return false;
+        }
+        FrameRecordingIndexEntry entry;
+        entry.role = static_cast<uint32_t>(role);
+        entry.frameNumber = frameNumber;
+        entry.offset = nextFrameOffset;
+        entry.byteCount = byteCount;
+        index.push_back(entry);
+
+        // The gap left by the alignment is never written, so it reads back as zeros
+        nextFrameOffset = (nextFrameOffset + byteCount + FRAME_RECORDING_ALIGNMENT - 1) / FRAME_RECORDING_ALIGNMENT *
+                          FRAME_RECORDING_ALIGNMENT;
+        return true;
+    }
+
+    bool FrameRecordingWriter::finish() {
+        if (!isOpen()) {
+            return true;
+        }
+        header.frameCount = static_cast<uint32_t>(index.size());
+        header.indexOffset = nextFrameOffset;
+        bool finished = writeAt(nextFrameOffset, index.data(), index.size() * sizeof(FrameRecordingIndexEntry)) &&
+                        writeAt(0, &header, sizeof(header));
+        if (!finished) {
+            LOG_WARN("FrameRecordingWriter", "Failed to write the index of the recording.");
+        }
+        close();
+        return finished;
+    }
+
+    bool FrameRecordingWriter::isOpen() const {
+        return fileDescriptor != -1;
+    }
+
+    bool FrameRecordingWriter::writeAt(const uint64_t offset, const void *data, const size_t byteCount) {
+        const uint8_t *remainingData = static_cast<const uint8_t *>(data);
+        size_t remainingByteCount = byteCount;
+        off_t position = static_cast<off_t>(offset);
+        while (remainingByteCount > 0) {
+            ssize_t written = pwrite(fileDescriptor, remainingData, remainingByteCount, position);
+            if (written <= 0) {
+                return false;
+            }
+            remainingData += written;
+            remainingByteCount -= written;
+            position += written;
+        }
+        return true;
+    }
+
+    void FrameRecordingWriter::close() {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+        index.clear();
+    }
+
+} //end namespace rbdt
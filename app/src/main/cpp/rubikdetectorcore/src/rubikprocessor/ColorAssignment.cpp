@@ -0,0 +1,136 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <limits>
+#include "../../include/rubikdetector/rubikprocessor/internal/ColorAssignment.hpp"
+
+namespace rbdt {
+
+    void ColorAssignment::solve(const std::array<cv::Vec3f, CubeState::FACELET_COUNT> &faceletColors,
+                                std::array<CubeState::Face, CubeState::FACELET_COUNT> &faces,
+                                std::array<cv::Scalar, CubeState::FACE_COUNT> &faceColors) {
+        int freeCount = 0;
+        for (int i = 0; i < CubeState::FACELET_COUNT; i++) {
+            if (i % FACELETS_PER_FACE == CENTER_INDEX) {
+                faces[i] = static_cast<CubeState::Face>(i / FACELETS_PER_FACE);
+            } else {
+                freeFacelets[freeCount] = i;
+                freeL[freeCount] = faceletColors[i][0];
+                freeA[freeCount] = faceletColors[i][1];
+                freeB[freeCount] = faceletColors[i][2];
+                freeCount++;
+            }
+        }
+
+        // The centers anchor the faces for the first round
+        for (int face = 0; face < CubeState::FACE_COUNT; face++) {
+            const cv::Vec3f &center = faceletColors[face * FACELETS_PER_FACE + CENTER_INDEX];
+            faceL[face] = center[0];
+            faceA[face] = center[1];
+            faceB[face] = center[2];
+        }
+
+        std::array<int, FREE_FACELET_COUNT> assignedFaces;
+        std::array<int, FREE_FACELET_COUNT> previousFaces;
+        previousFaces.fill(-1);
+        for (int round = 0; round < MAX_ROUNDS; round++) {
+            computeCosts();
+            assign(assignedFaces);
+            for (int i = 0; i < FREE_FACELET_COUNT; i++) {
+                faces[freeFacelets[i]] = static_cast<CubeState::Face>(assignedFaces[i]);
+            }
+
+            // Each face color becomes the mean of its 9 facelets, center included
+            faceL.fill(0);
+            faceA.fill(0);
+            faceB.fill(0);
+            for (int i = 0; i < CubeState::FACELET_COUNT; i++) {
+                const int face = static_cast<int>(faces[i]);
+                faceL[face] += faceletColors[i][0] / FACELETS_PER_FACE;
+                faceA[face] += faceletColors[i][1] / FACELETS_PER_FACE;
+                faceB[face] += faceletColors[i][2] / FACELETS_PER_FACE;
+            }
+
+            if (assignedFaces == previousFaces) {
+                // Same colors as the previous round, solving again would give the same assignment
+                break;
+            }
+            previousFaces = assignedFaces;
+        }
+
+        for (int face = 0; face < CubeState::FACE_COUNT; face++) {
+            faceColors[face] = toEncodedLab(faceL[face], faceA[face], faceB[face]);
+        }
+    }
+
+    cv::Scalar ColorAssignment::toEncodedLab(float l, float a, float b) {
+        return cv::Scalar(l * 255.0 / 100.0, a + 128.0, b + 128.0);
+    }
+
+    void ColorAssignment::computeCosts() {
+        const LabColors faceColors = {faceL.data(), faceA.data(), faceB.data(), CubeState::FACE_COUNT};
+        const LabColors freeColors = {freeL.data(), freeA.data(), freeB.data(), FREE_FACELET_COUNT};
+        computeCIEDE2000Matrix(faceColors, freeColors, costs.data());
+    }
+
+    void ColorAssignment::assign(std::array<int, FREE_FACELET_COUNT> &assignedFaces) {
+        // Each face offers FACELETS_PER_FACE - 1 slots, all with the cost of the face. Slot j belongs to face (j - 1) / slotsPerFace
+        const int slotsPerFace = FACELETS_PER_FACE - 1;
+        const double infinity = std::numeric_limits<double>::infinity();
+        rowPotentials.fill(0);
+        slotPotentials.fill(0);
+        slotRows.fill(0);
+        previousSlots.fill(0);
+
+        for (int row = 1; row <= FREE_FACELET_COUNT; row++) {
+            // Grow an augmenting path from the new row, slot 0 standing for it
+            slotRows[0] = row;
+            int slot = 0;
+            minSlack.fill(infinity);
+            visitedSlots.fill(false);
+            do {
+                visitedSlots[slot] = true;
+                const int pathRow = slotRows[slot];
+                const int pathFacelet = pathRow - 1;
+                double delta = infinity;
+                int nextSlot = 0;
+                for (int j = 1; j <= FREE_FACELET_COUNT; j++) {
+                    if (!visitedSlots[j]) {
+                        double slack = costs[((j - 1) / slotsPerFace) * FREE_FACELET_COUNT + pathFacelet] - rowPotentials[pathRow] -
+                                       slotPotentials[j];
+                        if (slack < minSlack[j]) {
+                            minSlack[j] = slack;
+                            previousSlots[j] = slot;
+                        }
+                        if (minSlack[j] < delta) {
+                            delta = minSlack[j];
+                            nextSlot = j;
+                        }
+                    }
+                }
+                for (int j = 0; j <= FREE_FACELET_COUNT; j++) {
+                    if (visitedSlots[j]) {
+                        rowPotentials[slotRows[j]] += delta;
+                        slotPotentials[j] -= delta;
+                    } else {
+                        minSlack[j] -= delta;
+                    }
+                }
+                slot = nextSlot;
+            } while (slotRows[slot] != 0);
+
+            // Flip the path
+            do {
+                const int previousSlot = previousSlots[slot];
+                slotRows[slot] = slotRows[previousSlot];
+                slot = previousSlot;
+            } while (slot != 0);
+        }
+
+        for (int j = 1; j <= FREE_FACELET_COUNT; j++) {
+            assignedFaces[slotRows[j] - 1] = (j - 1) / slotsPerFace;
+        }
+    }
+
+} //namespace rbdt
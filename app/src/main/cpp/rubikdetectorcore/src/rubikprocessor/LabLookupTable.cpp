@@ -0,0 +1,71 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+#include "../../include/rubikdetector/rubikprocessor/internal/LabLookupTable.hpp"
+
+namespace rbdt {
+
+    LabLookupTable::LabLookupTable() : nodes(GRID_SIZE * BLUE_STRIDE) {
+        const float step = 1.0f / (GRID_SIZE - 1);
+        std::vector<float> bgrNodes(nodes.size());
+        for (int b = 0; b < GRID_SIZE; b++) {
+            for (int g = 0; g < GRID_SIZE; g++) {
+                for (int r = 0; r < GRID_SIZE; r++) {
+                    float *node = &bgrNodes[b * BLUE_STRIDE + g * GREEN_STRIDE + r * CHANNELS];
+                    node[0] = b * step;
+                    node[1] = g * step;
+                    node[2] = r * step;
+                }
+            }
+        }
+        // Float input in [0, 1], so the nodes are converted exactly. The headers wrap the vectors, cvtColor writes in place
+        cv::Mat bgr(GRID_SIZE * GRID_SIZE * GRID_SIZE, 1, CV_32FC3, bgrNodes.data());
+        cv::Mat lab(GRID_SIZE * GRID_SIZE * GRID_SIZE, 1, CV_32FC3, nodes.data());
+        cv::cvtColor(bgr, lab, cv::COLOR_BGR2Lab);
+
+        for (int level = 0; level < 256; level++) {
+            const float position = level * (GRID_SIZE - 1) / 255.0f;
+            // 255 falls on the last node, which is reached with the full weight of the last cell instead
+            const int index = std::min(static_cast<int>(position), GRID_SIZE - 2);
+            cellIndices[level] = index;
+            cellWeights[level] = position - index;
+        }
+    }
+
+    cv::Vec3f LabLookupTable::convert(uint8_t blue, uint8_t green, uint8_t red) const {
+        float lab[CHANNELS] = {0, 0, 0};
+        accumulate(blue, green, red, lab);
+        return cv::Vec3f(lab[0], lab[1], lab[2]);
+    }
+
+    cv::Vec3f LabLookupTable::mean(const uint8_t *pixels, int pixelCount) const {
+        float labSum[CHANNELS] = {0, 0, 0};
+        for (int p = 0; p < pixelCount; p++, pixels += CHANNELS) {
+            accumulate(pixels[0], pixels[1], pixels[2], labSum);
+        }
+        return cv::Vec3f(labSum[0] / pixelCount, labSum[1] / pixelCount, labSum[2] / pixelCount);
+    }
+
+    void LabLookupTable::accumulate(uint8_t blue, uint8_t green, uint8_t red, float *lab) const {
+        const float blueWeight = cellWeights[blue];
+        const float greenWeight = cellWeights[green];
+        const float redWeight = cellWeights[red];
+        const float *corner = &nodes[cellIndices[blue] * BLUE_STRIDE + cellIndices[green] * GREEN_STRIDE +
+                                     cellIndices[red] * CHANNELS];
+        for (int channel = 0; channel < CHANNELS; channel++, corner++) {
+            // Along red, then green, then blue
+            const float c00 = corner[0] + (corner[CHANNELS] - corner[0]) * redWeight;
+            const float c01 = corner[GREEN_STRIDE] + (corner[GREEN_STRIDE + CHANNELS] - corner[GREEN_STRIDE]) * redWeight;
+            const float c10 = corner[BLUE_STRIDE] + (corner[BLUE_STRIDE + CHANNELS] - corner[BLUE_STRIDE]) * redWeight;
+            const float c11 = corner[BLUE_STRIDE + GREEN_STRIDE] +
+                              (corner[BLUE_STRIDE + GREEN_STRIDE + CHANNELS] - corner[BLUE_STRIDE + GREEN_STRIDE]) * redWeight;
+            const float c0 = c00 + (c01 - c00) * greenWeight;
+            const float c1 = c10 + (c11 - c10) * greenWeight;
+            lab[channel] += c0 + (c1 - c0) * blueWeight;
+        }
+    }
+
+} //namespace rbdt
@@ -5,18 +5,21 @@
 #include "../../include/rubikdetector/rubikprocessor/RubikProcessor.hpp"
 #include "../../include/rubikdetector/rubikprocessor/internal/RubikProcessorImpl.hpp"
 #include "../../include/rubikdetector/utils/CrossLog.hpp"
+#include "../../include/rubikdetector/utils/LatencyRecorder.hpp"
 #include "../../include/rubikdetector/data/config/ImageProperties.hpp"
 
 namespace rbdt {
 
     RubikProcessor::RubikProcessor(const ImageProperties scanProperties,
                                    const ImageProperties photoProperties,
+                                   const ResolutionProfile resolutionProfile,
                                    std::unique_ptr<RubikFaceletsDetector> faceletsDetector,
                                    std::unique_ptr<RubikColorDetector> colorDetector,
                                    std::shared_ptr<ImageSaver> imageSaver)
             : behavior(std::unique_ptr<RubikProcessorImpl>(
             new RubikProcessorImpl(scanProperties,
                                    photoProperties,
+                                   resolutionProfile,
                                    std::move(faceletsDetector),
                                    std::move(colorDetector),
                                    imageSaver))) {}
@@ -29,6 +32,10 @@ namespace rbdt {
         return behavior->processScan(scanData);
     }
 
+    ScanOutcome RubikProcessor::processScanWithOutcome(const uint8_t *scanData) {
+        return behavior->processScanWithOutcome(scanData);
+    }
+
     bool RubikProcessor::processPhoto(const uint8_t *scanData, const uint8_t *photoData) {
         return behavior->processPhoto(scanData, photoData);
     }
@@ -37,6 +44,54 @@ namespace rbdt {
         return behavior->processColors(imageData);
     }
 
+    bool RubikProcessor::submitScan(const uint8_t *scanData) {
+        return behavior->submitScan(scanData);
+    }
+
+    void RubikProcessor::flushScans() {
+        behavior->flushScans();
+    }
+
+    void RubikProcessor::setOnCubeDetectionResultListener(std::shared_ptr<OnCubeDetectionResultListener> listener) {
+        behavior->setOnCubeDetectionResultListener(listener);
+    }
+
+    std::vector<StageLatency> RubikProcessor::getStageLatencies() {
+        return LatencyRecorder::instance().snapshot();
+    }
+
+    void RubikProcessor::resetStageLatencies() {
+        LatencyRecorder::instance().reset();
+    }
+
+    void RubikProcessor::flushLogs() {
+        behavior->flushLogs();
+    }
+
+    bool RubikProcessor::startRecording(const std::string &path) {
+        return behavior->startRecording(path);
+    }
+
+    void RubikProcessor::stopRecording() {
+        behavior->stopRecording();
+    }
+
+    void RubikProcessor::setScanCascadeEnabled(bool enabled) {
+        behavior->setScanCascadeEnabled(enabled);
+    }
+
+    void RubikProcessor::setScanGateEnabled(bool enabled) {
+        behavior->setScanGateEnabled(enabled);
+    }
+
+    void RubikProcessor::setResolutionProfile(const ResolutionProfile profile) {
+        behavior->setResolutionProfile(profile);
+    }
+
+    ImagePatches RubikProcessor::getFaceletPatches(uint8_t *data) {
+        return behavior->getFaceletPatches(data);
+    }
+
     void RubikProcessor::updateScanPhase(const bool &isSecondPhase) {
         behavior->updateScanPhase(isSecondPhase);
     }
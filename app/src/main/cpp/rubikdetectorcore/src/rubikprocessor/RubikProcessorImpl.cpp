@@ -6,23 +6,35 @@
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
 #include <opencv2/imgproc/types_c.h>
-#include <future>
+#include <algorithm>
 #include "../../include/rubikdetector/utils/Utils.hpp"
 #include "../../include/rubikdetector/utils/CrossLog.hpp"
+#include "../../include/rubikdetector/utils/LatencyRecorder.hpp"
 #include "../../include/rubikdetector/data/config/ImageProperties.hpp"
 #include "../../include/rubikdetector/utils/CIEDE2000.h"
 
 namespace rbdt {
 
+    constexpr const char *RubikProcessorImpl::FACE_TAGS[3];
+
 /**##### PUBLIC API #####**/
     RubikProcessorImpl::RubikProcessorImpl(const ImageProperties scanProperties,
                                            const ImageProperties photoProperties,
+                                           const ResolutionProfile resolutionProfile,
                                            std::unique_ptr<RubikFaceletsDetector> faceletsDetector,
                                            std::unique_ptr<RubikColorDetector> colorDetector,
                                            std::shared_ptr<ImageSaver> imageSaver) :
             faceletsDetector(std::move(faceletsDetector)),
             colorDetector(std::move(colorDetector)),
-            imageSaver(imageSaver) {
+            imageSaver(imageSaver),
+            scanCascadeEnabled(true),
+            lastScanCubeFound(false),
+            scanGateEnabled(true),
+            detectionPool(DETECTION_WORKER_COUNT) {
+        for (std::atomic<float> &failureRate : faceFailureRates) {
+            failureRate.store(0.0f);
+        }
+        applyResolutionProfile(resolutionProfile);
         applyScanProperties(scanProperties);
         applyPhotoProperties(photoProperties);
     }
@@ -32,22 +44,134 @@ namespace rbdt {
     }
 
     bool RubikProcessorImpl::processScan(const uint8_t *scanData) {
-        return scanCubeInternal(scanData);
+        return processScanWithOutcome(scanData) == ScanOutcome::CUBE_FOUND;
+    }
+
+    ScanOutcome RubikProcessorImpl::processScanWithOutcome(const uint8_t *scanData) {
+        ScopedStageTimer timer(ProcessingStage::FRAME);
+        recordFrame(FrameRole::SCAN, frameNumber + 1, scanData + frameYUVOffset);
+        const bool gated = scanGateEnabled;
+        if (gated) {
+            ScanOutcome skipReason;
+            bool process;
+            {
+                ScopedStageTimer gateTimer(ProcessingStage::SCAN_GATE);
+                process = scanGate.shouldProcess(scanData + frameYUVOffset, skipReason);
+            }
+            if (!process) {
+                frameNumber++;
+                LOG_VERBOSE("NativeRubikProcessor", "Skipped scan frame %d, reason %d.", frameNumber, static_cast<int>(skipReason));
+                return skipReason;
+            }
+        }
+        bool cubeFound = scanCubeInternal(scanData);
+        if (gated) {
+            scanGate.onProcessed(cubeFound);
+        }
+        return cubeFound ? ScanOutcome::CUBE_FOUND : ScanOutcome::CUBE_NOT_FOUND;
     }
 
     bool RubikProcessorImpl::processPhoto(const uint8_t *scanData, const uint8_t *photoData) {
+        ScopedStageTimer timer(ProcessingStage::FRAME);
+        // extractFaceletsInternal() numbers the photo as the next frame
+        recordFrame(FrameRole::PHOTO, frameNumber + 1, photoData);
         return extractFaceletsInternal(scanData, photoData);
     }
 
     CubeState RubikProcessorImpl::processColors(const uint8_t *imageData) {
+        ScopedStageTimer timer(ProcessingStage::FRAME);
         return analyzeColorsInternal(imageData);
     }
 
+    bool RubikProcessorImpl::submitScan(const uint8_t *scanData) {
+        if (scanPipeline == nullptr) {
+            // Only pay for the pipeline threads & slots once the asynchronous API is actually used
+            scanPipeline = std::unique_ptr<ScanPipeline>(new ScanPipeline(
+                    SCAN_PIPELINE_DEPTH,
+                    3 * faceGrayByteCount,
+                    [this](const uint8_t *frameData, uint8_t *facesData) {
+                        prepareScanFaces(frameData, facesData);
+                    },
+                    [this](uint8_t *facesData, int frameNr) {
+                        return detectScanFaces(facesData, frameNr);
+                    }));
+            scanPipeline->setListener(resultListener);
+        }
+        int nextFrameNumber = frameNumber + 1;
+        bool accepted = scanPipeline->submit(scanData, nextFrameNumber);
+        if (accepted) {
+            frameNumber = nextFrameNumber;
+            recordFrame(FrameRole::SCAN, nextFrameNumber, scanData + frameYUVOffset);
+        }
+        return accepted;
+    }
+
+    void RubikProcessorImpl::flushScans() {
+        if (scanPipeline != nullptr) {
+            scanPipeline->flush();
+        }
+    }
+
+    void RubikProcessorImpl::setOnCubeDetectionResultListener(std::shared_ptr<OnCubeDetectionResultListener> listener) {
+        resultListener = listener;
+        if (scanPipeline != nullptr) {
+            scanPipeline->setListener(listener);
+        }
+    }
+
+    void RubikProcessorImpl::flushLogs() {
+        LOG_FLUSH();
+    }
+
+    bool RubikProcessorImpl::startRecording(const std::string &path) {
+        std::lock_guard<std::mutex> lock(recordingMutex);
+        return recordingWriter.open(path,
+                                    ImageProperties(scanRotation, scanWidth, scanHeight),
+                                    ImageProperties(photoRotation, photoWidth, photoHeight));
+    }
+
+    void RubikProcessorImpl::stopRecording() {
+        std::lock_guard<std::mutex> lock(recordingMutex);
+        recordingWriter.finish();
+    }
+
+    void RubikProcessorImpl::setScanCascadeEnabled(bool enabled) {
+        scanCascadeEnabled = enabled;
+    }
+
+    void RubikProcessorImpl::setScanGateEnabled(bool enabled) {
+        scanGateEnabled = enabled;
+    }
+
+    void RubikProcessorImpl::setResolutionProfile(const ResolutionProfile profile) {
+        if (profile == resolutionProfile) {
+            return;
+        }
+        // Frames already in the pipeline were submitted for the old layout, and its slots are sized for the old faces. It gets
+        // recreated on the next RubikProcessor::submitScan()
+        flushScans();
+        scanPipeline.reset();
+
+        applyResolutionProfile(profile);
+        applyScanProperties(ImageProperties(scanRotation, scanWidth, scanHeight));
+        applyPhotoProperties(ImageProperties(photoRotation, photoWidth, photoHeight));
+    }
+
     void RubikProcessorImpl::updateScanPhase(const bool &isSecondPhase) {
         applyScanPhase(isSecondPhase);
     }
 
     void RubikProcessorImpl::updateImageProperties(const ImageProperties &newProperties) {
+        // Frames already in the pipeline were submitted for the old properties
+        flushScans();
+        {
+            std::lock_guard<std::mutex> lock(recordingMutex);
+            if (recordingWriter.isOpen()) {
+                // A recording holds frames of a single size
+                LOG_WARN("NativeRubikProcessor", "Scan properties changed, stopping the recording.");
+                recordingWriter.finish();
+            }
+        }
         applyScanProperties(newProperties);
     }
 
@@ -59,6 +183,12 @@ namespace rbdt {
         return firstFaceletOffset;
     }
 
+    ImagePatches RubikProcessorImpl::getFaceletPatches(uint8_t *data) {
+        return ImagePatches(data + firstFaceletOffset, CubeState::FACELET_COUNT, DEFAULT_FACELET_DIMENSION,
+                            DEFAULT_FACELET_DIMENSION, CV_8UC3, static_cast<size_t>(faceletByteCount),
+                            ImagePatches::ColorSpace::BGR);
+    }
+
     int RubikProcessorImpl::getFaceletsByteCount() {
         return (27 * faceletByteCount);
     }
@@ -78,6 +208,26 @@ namespace rbdt {
         this->isSecondPhase = isSecondPhase;
     }
 
+    void RubikProcessorImpl::applyResolutionProfile(const ResolutionProfile profile) {
+        resolutionProfile = profile;
+        switch (profile) {
+            case ResolutionProfile::FAST:
+                processingDimension = FAST_DIMENSION;
+                faceDimension = FAST_FACE_DIMENSION;
+                break;
+            case ResolutionProfile::PRECISE:
+                processingDimension = PRECISE_DIMENSION;
+                faceDimension = PRECISE_FACE_DIMENSION;
+                break;
+            case ResolutionProfile::DEFAULT:
+            default:
+                processingDimension = DEFAULT_DIMENSION;
+                faceDimension = DEFAULT_FACE_DIMENSION;
+                break;
+        }
+        LOG_DEBUG("NativeRubikProcessor", "Resolution profile: processing frame %d, faces %d.", processingDimension, faceDimension);
+    }
+
     void RubikProcessorImpl::applyScanProperties(const ImageProperties &properties) {
         scanWidth = properties.width;
         scanHeight = properties.height;
@@ -98,28 +248,144 @@ namespace rbdt {
 
         scanRotation = properties.rotation;
 
-        scanScalingRatio = (float) DEFAULT_DIMENSION / scanDimension;
+        scanScalingRatio = (float) processingDimension / scanDimension;
         scanNeedsResize = scanScalingRatio != 1;
 
         // Calculate offsets
         frameYUVByteCount = scanWidth * (scanHeight + scanHeight / 2);
         frameYUVOffset = RubikProcessorImpl::NO_OFFSET;
 
-        frameGrayByteCount = scanWidth * scanHeight;
-        frameGrayOffset = frameYUVOffset + frameYUVByteCount;
-
-        faceGrayByteCount = DEFAULT_FACE_DIMENSION * DEFAULT_FACE_DIMENSION;
-        firstFaceGrayOffset = frameGrayOffset + frameGrayByteCount;
+        // The faces are sampled straight from the Y plane, no intermediate gray frame is stored
+        faceGrayByteCount = faceDimension * faceDimension;
+        firstFaceGrayOffset = frameYUVOffset + frameYUVByteCount;
 
         faceletByteCount = DEFAULT_FACELET_DIMENSION * DEFAULT_FACELET_DIMENSION * 3;
         firstFaceletOffset = firstFaceGrayOffset + (3 * faceGrayByteCount);
 
         totalRequiredMemory = frameYUVByteCount +
-                              frameGrayByteCount +
                               (3 * faceGrayByteCount) +
                               (54 * faceletByteCount);
 
-        faceletsDetector->onFrameSizeSelected(DEFAULT_FACE_DIMENSION);
+        buildFaceHomographies();
+        buildScanFaceMaps();
+        scanGate.configure(scanWidth, scanHeight, scanCroppingRegion);
+
+        faceletsDetector->onFrameSizeSelected(faceDimension);
+    }
+
+    void RubikProcessorImpl::buildFaceHomographies() {
+        if (faceHomographiesDimension == processingDimension && faceHomographiesFaceDimension == faceDimension) {
+            // The face geometry only depends on the processing & face dimensions, rotation is applied before the faces are extracted
+            return;
+        }
+        std::vector<cv::Point2f> topFaceCorners;
+        std::vector<cv::Point2f> leftFaceCorners;
+        std::vector<cv::Point2f> rightFaceCorners;
+        computeFaceCorners(topFaceCorners, leftFaceCorners, rightFaceCorners);
+        const std::vector<cv::Point2f> *facesCorners[3] = {&topFaceCorners, &leftFaceCorners, &rightFaceCorners};
+        std::vector<cv::Point2f> outputPoints = computeOutputCorners(cv::Size(faceDimension, faceDimension));
+
+        for (int face = 0; face < 3; face++) {
+            faceHomographies[face] = cv::getPerspectiveTransform(*facesCorners[face], outputPoints);
+            inverseFaceHomographies[face] = cv::getPerspectiveTransform(outputPoints, *facesCorners[face]);
+        }
+        faceHomographiesDimension = processingDimension;
+        faceHomographiesFaceDimension = faceDimension;
+    }
+
+    void RubikProcessorImpl::buildScanFaceMaps() {
+        // From processing frame coordinates back to the cropped, full resolution frame. Matches the pixel center convention of cv::resize
+        const float inverseScalingRatio = 1 / scanScalingRatio;
+
+        for (int face = 0; face < 3; face++) {
+            // Maps face pixels to processing frame pixels
+            const double *h = inverseFaceHomographies[face].ptr<double>(0);
+
+            cv::Mat mapX(faceDimension, faceDimension, CV_32FC1);
+            cv::Mat mapY(faceDimension, faceDimension, CV_32FC1);
+            for (int y = 0; y < faceDimension; y++) {
+                float *mapXRow = mapX.ptr<float>(y);
+                float *mapYRow = mapY.ptr<float>(y);
+                for (int x = 0; x < faceDimension; x++) {
+                    // Undo the perspective transform
+                    double w = h[6] * x + h[7] * y + h[8];
+                    float processingX = static_cast<float>((h[0] * x + h[1] * y + h[2]) / w);
+                    float processingY = static_cast<float>((h[3] * x + h[4] * y + h[5]) / w);
+
+                    float resizedX = processingX;
+                    float resizedY = processingY;
+                    undoRotation(resizedX, resizedY, scanRotation);
+
+                    // Undo the resize & the crop
+                    mapXRow[x] = (resizedX + 0.5f) * inverseScalingRatio - 0.5f + scanCroppingRegion.x;
+                    mapYRow[x] = (resizedY + 0.5f) * inverseScalingRatio - 0.5f + scanCroppingRegion.y;
+                }
+            }
+            // Fixed point maps are noticeably faster to sample than the float ones
+            cv::convertMaps(mapX, mapY, scanFaceMaps[face], scanFaceMapsInterpolation[face], CV_16SC2);
+        }
+    }
+
+    void RubikProcessorImpl::undoRotation(float &x, float &y, int rotation) const {
+        // Same cases as rotateMat()
+        const float lastProcessingPixel = processingDimension - 1;
+        const float rotatedX = x;
+        const float rotatedY = y;
+        if (rotation == 90) {
+            x = rotatedY;
+            y = lastProcessingPixel - rotatedX;
+        } else if (rotation == 270 || rotation == -90) {
+            x = lastProcessingPixel - rotatedY;
+            y = rotatedX;
+        } else if (rotation == 180) {
+            x = lastProcessingPixel - rotatedX;
+            y = lastProcessingPixel - rotatedY;
+        }
+    }
+
+    void RubikProcessorImpl::computePhotoRegions() {
+        std::vector<cv::Point2f> topFaceCorners;
+        std::vector<cv::Point2f> leftFaceCorners;
+        std::vector<cv::Point2f> rightFaceCorners;
+        computeFaceCorners(topFaceCorners, leftFaceCorners, rightFaceCorners);
+        std::vector<cv::Point2f> corners;
+        corners.insert(corners.end(), topFaceCorners.begin(), topFaceCorners.end());
+        corners.insert(corners.end(), leftFaceCorners.begin(), leftFaceCorners.end());
+        corners.insert(corners.end(), rightFaceCorners.begin(), rightFaceCorners.end());
+
+        // Bounding box of the faces in the processing frame, before it gets rotated
+        float minX = processingDimension;
+        float minY = processingDimension;
+        float maxX = 0;
+        float maxY = 0;
+        for (const cv::Point2f &corner : corners) {
+            float x = corner.x;
+            float y = corner.y;
+            undoRotation(x, y, photoRotation);
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+
+        // One extra pixel on each side for the interpolation of the warp, and even bounds since the NV21 chroma is subsampled by 2
+        int regionLeft = std::max(0, (static_cast<int>(std::floor(minX)) - 1) & ~1);
+        int regionTop = std::max(0, (static_cast<int>(std::floor(minY)) - 1) & ~1);
+        int regionRight = std::min(processingDimension, (static_cast<int>(std::ceil(maxX)) + 3) & ~1);
+        int regionBottom = std::min(processingDimension, (static_cast<int>(std::ceil(maxY)) + 3) & ~1);
+        photoFacesRegion = cv::Rect(regionLeft, regionTop, regionRight - regionLeft, regionBottom - regionTop);
+
+        // Same region in the full resolution photo
+        const float inverseScalingRatio = 1 / photoScalingRatio;
+        int sourceX = (photoCroppingRegion.x + cvRound(regionLeft * inverseScalingRatio)) & ~1;
+        int sourceY = (photoCroppingRegion.y + cvRound(regionTop * inverseScalingRatio)) & ~1;
+        int sourceWidth = std::min((cvRound(photoFacesRegion.width * inverseScalingRatio) + 1) & ~1, (photoWidth - sourceX) & ~1);
+        int sourceHeight = std::min((cvRound(photoFacesRegion.height * inverseScalingRatio) + 1) & ~1, (photoHeight - sourceY) & ~1);
+        photoSourceRegion = cv::Rect(sourceX, sourceY, sourceWidth, sourceHeight);
+
+        LOG_DEBUG("NativeRubikProcessor", "Photo faces region: x %d, y %d, width %d, height %d. Source region: x %d, y %d, width %d, height %d.",
+                  photoFacesRegion.x, photoFacesRegion.y, photoFacesRegion.width, photoFacesRegion.height,
+                  photoSourceRegion.x, photoSourceRegion.y, photoSourceRegion.width, photoSourceRegion.height);
     }
 
     void RubikProcessorImpl::applyPhotoProperties(const ImageProperties &properties) {
@@ -142,10 +408,13 @@ namespace rbdt {
 
         photoRotation = properties.rotation;
 
-        photoScalingRatio = (float) DEFAULT_DIMENSION / photoDimension;
+        photoScalingRatio = (float) processingDimension / photoDimension;
         photoNeedsResize = photoScalingRatio != 1;
 
-        faceletsDetector->onFrameSizeSelected(DEFAULT_FACE_DIMENSION);
+        buildFaceHomographies();
+        computePhotoRegions();
+
+        faceletsDetector->onFrameSizeSelected(faceDimension);
     }
 
     bool RubikProcessorImpl::scanCubeInternal(const uint8_t *scanData) {
@@ -154,33 +423,16 @@ namespace rbdt {
         double processingStart = rbdt::getCurrentTimeMillis();
         /* Frame rate stuff */
 
-        // Allocate the mats
-        cv::Mat frameYUV(scanHeight + scanHeight / 2, scanWidth, CV_8UC1, (uchar *) scanData);
-        cv::Mat frameGray(scanHeight, scanWidth, CV_8UC1, (uchar *) scanData + frameGrayOffset);
-
-        cv::Mat topFaceGray(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION, CV_8UC1,
-                            (uchar *) scanData + firstFaceGrayOffset);
-        cv::Mat leftFaceGray(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION, CV_8UC1,
-                             (uchar *) scanData + firstFaceGrayOffset + faceGrayByteCount);
-        cv::Mat rightFaceGray(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION, CV_8UC1,
-                              (uchar *) scanData + firstFaceGrayOffset + (2 * faceGrayByteCount));
-
-        // Gray
-        cv::cvtColor(frameYUV, frameGray, cv::COLOR_YUV2GRAY_NV21);
-
-        // Crop, resize and rotate
-        cropResizeAndRotate(frameGray, scanNeedsCrop, scanCroppingRegion, scanDimension, scanNeedsResize, scanRotation);
-
-        // Perspective transform to extract the faces
-        extractFaces(frameGray, topFaceGray, leftFaceGray, rightFaceGray);
-
-        //TODO parallelize this
-        LOG_DEBUG("NativeRubikProcessor", "DETECTING SCAN FACES.");
-        std::vector<std::vector<RubikFacelet>> topFacelets = faceletsDetector->detect(topFaceGray, "top_face_", frameNumber);
-        std::vector<std::vector<RubikFacelet>> leftFacelets = faceletsDetector->detect(leftFaceGray, "left_face_", frameNumber);
-        std::vector<std::vector<RubikFacelet>> rightFacelets = faceletsDetector->detect(rightFaceGray, "right_face_", frameNumber);
-
-        bool cubeFound = !topFacelets.empty() && !leftFacelets.empty() && !rightFacelets.empty();
+        // The gray faces are written to the shared buffer, right after the NV21 frame
+        uint8_t *facesData = (uint8_t *) scanData + firstFaceGrayOffset;
+        bool cubeFound;
+        if (scanCascadeEnabled) {
+            // Each face is only sampled once the previous ones were found
+            cubeFound = detectScanFacesCascade(scanData, facesData, frameNumber);
+        } else {
+            prepareScanFaces(scanData, facesData);
+            cubeFound = detectScanFaces(facesData, frameNumber);
+        }
 
         /* Frame rate stuff */
         double processingEnd = rbdt::getCurrentTimeMillis();
@@ -196,79 +448,207 @@ namespace rbdt {
         return cubeFound;
     }
 
+    void RubikProcessorImpl::prepareScanFaces(const uint8_t *scanData, uint8_t *facesData) {
+        for (int face = 0; face < 3; face++) {
+            warpScanFace(face, scanData, facesData);
+        }
+    }
+
+    void RubikProcessorImpl::warpScanFace(const int face, const uint8_t *scanData, uint8_t *facesData) {
+        static const ProcessingStage warpStages[3] = {ProcessingStage::TOP_FACE_WARP,
+                                                      ProcessingStage::LEFT_FACE_WARP,
+                                                      ProcessingStage::RIGHT_FACE_WARP};
+        // The Y plane at the start of the NV21 frame already is the grayscale frame
+        cv::Mat frameY(scanHeight, scanWidth, CV_8UC1, (uchar *) scanData);
+        cv::Mat faceGray(faceDimension, faceDimension, CV_8UC1, facesData + face * faceGrayByteCount);
+
+        // Crop, resize, rotate and perspective transform in a single pass
+        ScopedStageTimer timer(warpStages[face]);
+        cv::remap(frameY, faceGray, scanFaceMaps[face], scanFaceMapsInterpolation[face], cv::INTER_LINEAR);
+    }
+
+    bool RubikProcessorImpl::detectScanFaces(uint8_t *facesData, int frameNr) {
+        if (scanCascadeEnabled) {
+            // The faces were already sampled by the first stage of the ScanPipeline
+            return detectScanFacesCascade(nullptr, facesData, frameNr);
+        }
+        cv::Mat topFaceGray(faceDimension, faceDimension, CV_8UC1, facesData);
+        cv::Mat leftFaceGray(faceDimension, faceDimension, CV_8UC1, facesData + faceGrayByteCount);
+        cv::Mat rightFaceGray(faceDimension, faceDimension, CV_8UC1, facesData + (2 * faceGrayByteCount));
+
+        LOG_DEBUG("NativeRubikProcessor", "DETECTING SCAN FACES.");
+        FaceGrid topGrid;
+        FaceGrid leftGrid;
+        FaceGrid rightGrid;
+        return detectFaces(topFaceGray, leftFaceGray, rightFaceGray, frameNr, true, topGrid, leftGrid, rightGrid);
+    }
+
+    bool RubikProcessorImpl::detectScanFacesCascade(const uint8_t *scanData, uint8_t *facesData, int frameNr) {
+        // The face which failed most often recently goes first, since one failed face is enough to reject the frame
+        int faces[3] = {0, 1, 2};
+        std::stable_sort(faces, faces + 3, [this](int first, int second) {
+            return faceFailureRates[first].load(std::memory_order_relaxed) > faceFailureRates[second].load(std::memory_order_relaxed);
+        });
+        cv::Mat facesGray[3];
+        for (int face = 0; face < 3; face++) {
+            facesGray[face] = cv::Mat(faceDimension, faceDimension, CV_8UC1, facesData + face * faceGrayByteCount);
+        }
+
+        // The cube is probably in view, screening one face first would only delay the other two
+        if (lastScanCubeFound.load(std::memory_order_relaxed) ||
+            faceFailureRates[faces[0]].load(std::memory_order_relaxed) < CASCADE_FAILURE_RATE) {
+            if (scanData != nullptr) {
+                prepareScanFaces(scanData, facesData);
+            }
+            FaceGrid grids[3];
+            bool cubeFound = detectFaces(facesGray[0], facesGray[1], facesGray[2], frameNr, true, grids[0], grids[1], grids[2]);
+            for (int face = 0; face < 3; face++) {
+                updateFaceFailureRate(face, grids[face].found);
+            }
+            lastScanCubeFound.store(cubeFound, std::memory_order_relaxed);
+            return cubeFound;
+        }
+
+        if (scanData != nullptr) {
+            warpScanFace(faces[0], scanData, facesData);
+        }
+        bool firstFaceFound = faceletsDetector->detect(facesGray[faces[0]], FACE_TAGS[faces[0]], frameNr).found;
+        updateFaceFailureRate(faces[0], firstFaceFound);
+        if (!firstFaceFound) {
+            LOG_DEBUG("NativeRubikProcessor", "%s not found, skipping the other faces.", FACE_TAGS[faces[0]]);
+            lastScanCubeFound.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        // The two remaining faces are detected in parallel, one of them on the calling thread
+        if (scanData != nullptr) {
+            warpScanFace(faces[1], scanData, facesData);
+            warpScanFace(faces[2], scanData, facesData);
+        }
+        TaskLatch latch(1);
+        FaceDetectionTask pooledTask(*faceletsDetector, facesGray[faces[1]], faces[1], frameNr, true, latch);
+        FaceDetectionTask lastTask(*faceletsDetector, facesGray[faces[2]], faces[2], frameNr, true, latch);
+        detectionPool.post(pooledTask);
+        bool lastFaceFound;
+        try {
+            lastFaceFound = lastTask.detect().found;
+        } catch (...) {
+            // The pooled task lives on this stack frame, it must be done before unwinding it
+            latch.wait();
+            throw;
+        }
+        latch.wait();
+        if (pooledTask.error) {
+            std::rethrow_exception(pooledTask.error);
+        }
+        bool pooledFaceFound = pooledTask.grid.found;
+        updateFaceFailureRate(faces[1], pooledFaceFound);
+        updateFaceFailureRate(faces[2], lastFaceFound);
+        lastScanCubeFound.store(pooledFaceFound && lastFaceFound, std::memory_order_relaxed);
+        return pooledFaceFound && lastFaceFound;
+    }
+
+    void RubikProcessorImpl::updateFaceFailureRate(const int face, const bool found) {
+        // Exponential moving average, the last few frames weigh the most
+        float rate = faceFailureRates[face].load(std::memory_order_relaxed);
+        faceFailureRates[face].store(rate + ((found ? 0.0f : 1.0f) - rate) * FACE_FAILURE_RATE_WEIGHT, std::memory_order_relaxed);
+    }
+
     bool RubikProcessorImpl::extractFaceletsInternal(const uint8_t *scanData, const uint8_t *photoData) {
         /* Frame rate stuff */
         frameNumber++;
         double processingStart = rbdt::getCurrentTimeMillis();
         /* Frame rate stuff */
 
-        // Allocate the mats
-        cv::Mat frameYUV(photoHeight + photoHeight / 2, photoWidth, CV_8UC1, (uchar *) photoData);
-        cv::Mat frameGray;
-
-        cv::Mat topFaceGray;
-        cv::Mat leftFaceGray;
-        cv::Mat rightFaceGray;
-
-        // Gray
-        cv::cvtColor(frameYUV, frameGray, cv::COLOR_YUV2GRAY_NV21);
+        // Only the region covered by the faces is converted & downscaled, straight from the full resolution photo. The region is
+        // kept as a small NV21 image so the chroma can be added later on if the cube is found
+        const int regionWidth = photoFacesRegion.width;
+        const int regionHeight = photoFacesRegion.height;
+        cv::Mat photoY(photoHeight, photoWidth, CV_8UC1, (uchar *) photoData);
+        cv::Mat regionYUV(regionHeight + regionHeight / 2, regionWidth, CV_8UC1);
+        cv::Mat regionY = regionYUV(cv::Rect(0, 0, regionWidth, regionHeight));
+        {
+            ScopedStageTimer timer(ProcessingStage::Y_EXTRACTION);
+            resizePhotoRegion(photoY(photoSourceRegion), regionY);
+        }
 
-        imageSaver->saveImage(frameGray, 0, "_photo");
+        if (isSavingImages(imageSaver)) {
+            imageSaver->saveImage(regionY, 0, "_photo");
+        }
 
-        // Crop, resize and rotate
-        cropResizeAndRotate(frameGray, photoNeedsCrop, photoCroppingRegion, photoDimension, photoNeedsResize, photoRotation);
+        // Place the region in the processing frame & rotate
+        cv::Mat frameGray = cv::Mat::zeros(processingDimension, processingDimension, CV_8UC1);
+        {
+            ScopedStageTimer timer(ProcessingStage::CROP_RESIZE_ROTATE);
+            cv::Mat frameGrayRegion = frameGray(photoFacesRegion);
+            regionY.copyTo(frameGrayRegion);
+            rotateMat(frameGray, photoRotation);
+        }
 
-        imageSaver->saveImage(frameGray, 0, "_photo_crop_resize_rotate");
+        if (isSavingImages(imageSaver)) {
+            imageSaver->saveImage(frameGray, 0, "_photo_crop_resize_rotate");
+        }
 
         // Perspective transform to extract the faces
+        cv::Mat topFaceGray;
+        cv::Mat leftFaceGray;
+        cv::Mat rightFaceGray;
         extractFaces(frameGray, topFaceGray, leftFaceGray, rightFaceGray);
 
-        //TODO parallelize this
         LOG_DEBUG("NativeRubikProcessor", "DETECTING PHOTO FACES.");
-        imageSaver->saveImage(topFaceGray, 0, "top_face_photo");
-        imageSaver->saveImage(leftFaceGray, 0, "left_face_photo");
-        imageSaver->saveImage(rightFaceGray, 0, "right_face_photo");
-        std::vector<std::vector<RubikFacelet>> topFacelets = faceletsDetector->detect(topFaceGray, "top_face_", frameNumber);
-        std::vector<std::vector<RubikFacelet>> leftFacelets = faceletsDetector->detect(leftFaceGray, "left_face_", frameNumber);
-        std::vector<std::vector<RubikFacelet>> rightFacelets = faceletsDetector->detect(rightFaceGray, "right_face_", frameNumber);
-
-        bool cubeFound = !topFacelets.empty() && !leftFacelets.empty() && !rightFacelets.empty();
+        if (isSavingImages(imageSaver)) {
+            imageSaver->saveImage(topFaceGray, 0, "top_face_photo");
+            imageSaver->saveImage(leftFaceGray, 0, "left_face_photo");
+            imageSaver->saveImage(rightFaceGray, 0, "right_face_photo");
+        }
+        FaceGrid topGrid;
+        FaceGrid leftGrid;
+        FaceGrid rightGrid;
+        bool cubeFound = detectFaces(topFaceGray, leftFaceGray, rightFaceGray, frameNumber, false, topGrid, leftGrid, rightGrid);
         if (cubeFound) {
             LOG_DEBUG("NativeRubikProcessor", "CUBE FOUND!.");
 
-            // Repeat the process the gray image went through with HSV. Since this is only done once when the cube
-            // is actually found it's cheaper than doing it every frame
-            cv::Mat frame;
-            cv::cvtColor(frameYUV, frame, cv::COLOR_YUV2BGR_NV21);
+            // Repeat the process the gray image went through in color. Since this is only done once when the cube
+            // is actually found it's cheaper than doing it every frame. Only the chroma of the region is missing at this point
+            cv::Mat photoUV(photoHeight / 2, photoWidth / 2, CV_8UC2, (uchar *) photoData + photoWidth * photoHeight);
+            cv::Rect sourceUVRegion(photoSourceRegion.x / 2, photoSourceRegion.y / 2, photoSourceRegion.width / 2,
+                                    photoSourceRegion.height / 2);
+            cv::Mat regionUV(regionHeight / 2, regionWidth / 2, CV_8UC2, regionYUV.ptr<uchar>(regionHeight));
+            resizePhotoRegion(photoUV(sourceUVRegion), regionUV);
+
+            cv::Mat regionBGR;
+            cv::cvtColor(regionYUV, regionBGR, cv::COLOR_YUV2BGR_NV21);
             /**/
-            if (!isSecondPhase) {
-                imageSaver->saveImage(frame, 0, "complete_first");
-            } else {
-                imageSaver->saveImage(frame, 0, "complete_second");
+            if (isSavingImages(imageSaver)) {
+                imageSaver->saveImage(regionBGR, 0, !isSecondPhase ? "complete_first" : "complete_second");
             }
             /**/
-            cropResizeAndRotate(frame, photoNeedsCrop, photoCroppingRegion, photoDimension, photoNeedsResize, photoRotation);
+            cv::Mat frame = cv::Mat::zeros(processingDimension, processingDimension, CV_8UC3);
+            {
+                ScopedStageTimer timer(ProcessingStage::CROP_RESIZE_ROTATE);
+                cv::Mat frameRegion = frame(photoFacesRegion);
+                regionBGR.copyTo(frameRegion);
+                rotateMat(frame, photoRotation);
+            }
 
-            cv::Mat topFace(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION, CV_8UC3);
-            cv::Mat leftFace(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION, CV_8UC3);
-            cv::Mat rightFace(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION, CV_8UC3);
+            cv::Mat topFace(faceDimension, faceDimension, CV_8UC3);
+            cv::Mat leftFace(faceDimension, faceDimension, CV_8UC3);
+            cv::Mat rightFace(faceDimension, faceDimension, CV_8UC3);
 
             extractFaces(frame, topFace, leftFace, rightFace);
 
             /**/
-            if (!isSecondPhase) {
-                imageSaver->saveImage(topFace, 0, "top_first");
-                imageSaver->saveImage(leftFace, 0, "left_first");
-                imageSaver->saveImage(rightFace, 0, "right_first");
-            } else {
-                imageSaver->saveImage(topFace, 0, "top_second");
-                imageSaver->saveImage(leftFace, 0, "left_second");
-                imageSaver->saveImage(rightFace, 0, "right_second");
+            if (isSavingImages(imageSaver)) {
+                const std::string phaseSuffix = !isSecondPhase ? "_first" : "_second";
+                imageSaver->saveImage(topFace, 0, "top" + phaseSuffix);
+                imageSaver->saveImage(leftFace, 0, "left" + phaseSuffix);
+                imageSaver->saveImage(rightFace, 0, "right" + phaseSuffix);
             }
             /**/
 
             // Write the facelets to the
-            saveFacelets(topFacelets, topFace, leftFacelets, leftFace, rightFacelets, rightFace, scanData);
+            ScopedStageTimer timer(ProcessingStage::SAVE_FACELETS);
+            saveFacelets(topGrid, topFace, leftGrid, leftFace, rightGrid, rightFace, scanData);
         }
 
         /* Frame rate stuff */
@@ -285,6 +665,56 @@ namespace rbdt {
         return cubeFound;
     }
 
+    bool RubikProcessorImpl::detectFaces(cv::Mat &topFace, cv::Mat &leftFace, cv::Mat &rightFace, const int frameNr, const bool tracking,
+                                         FaceGrid &topGrid, FaceGrid &leftGrid, FaceGrid &rightGrid) {
+        // Top and left faces go to the pool while the calling thread takes care of the right face
+        TaskLatch latch(2);
+        FaceDetectionTask topTask(*faceletsDetector, topFace, 0, frameNr, tracking, latch);
+        FaceDetectionTask leftTask(*faceletsDetector, leftFace, 1, frameNr, tracking, latch);
+        FaceDetectionTask rightTask(*faceletsDetector, rightFace, 2, frameNr, tracking, latch);
+        detectionPool.post(topTask);
+        detectionPool.post(leftTask);
+        try {
+            rightGrid = rightTask.detect();
+        } catch (...) {
+            // The pooled tasks live on this stack frame, they must be done before unwinding it
+            latch.wait();
+            throw;
+        }
+        latch.wait();
+        for (FaceDetectionTask *pooledTask : {&topTask, &leftTask}) {
+            if (pooledTask->error) {
+                std::rethrow_exception(pooledTask->error);
+            }
+        }
+        topGrid = topTask.grid;
+        leftGrid = leftTask.grid;
+        return topGrid.found && leftGrid.found && rightGrid.found;
+    }
+
+    RubikProcessorImpl::FaceDetectionTask::FaceDetectionTask(RubikFaceletsDetector &detector, cv::Mat &face, const int faceIndex,
+                                                             const int frameNr, const bool tracking, TaskLatch &latch) :
+            detector(detector),
+            face(face),
+            faceIndex(faceIndex),
+            frameNr(frameNr),
+            tracking(tracking),
+            latch(latch) {}
+
+    FaceGrid RubikProcessorImpl::FaceDetectionTask::detect() {
+        return tracking ? detector.detect(face, FACE_TAGS[faceIndex], frameNr)
+                        : detector.detectUntracked(face, FACE_TAGS[faceIndex], frameNr);
+    }
+
+    void RubikProcessorImpl::FaceDetectionTask::run() {
+        try {
+            grid = detect();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        latch.countDown();
+    }
+
     void RubikProcessorImpl::rotateMat(cv::Mat &matImage, int rotFlag) {
         if (rotFlag != 0 && rotFlag != 360) {
             if (rotFlag == 90) {
@@ -299,115 +729,112 @@ namespace rbdt {
         }
     }
 
-    void RubikProcessorImpl::cropResizeAndRotate(cv::Mat &matImage, bool needsCrop, const cv::Rect &croppingRegion, int frameDimension,
-                                                 bool needsResize, int rotation) {
-        // Crop
-        if (needsCrop) {
-            LOG_DEBUG("NativeRubikProcessor",
-                      "Cropping frame of width %d and height %d into a square of width %d, height %d, x %d and y %d.",
-                      matImage.cols, matImage.rows, croppingRegion.width, croppingRegion.height, croppingRegion.x, croppingRegion.y);
-            matImage = matImage(croppingRegion);
-            matImage.cols = frameDimension;
-            matImage.rows = frameDimension;
+    void RubikProcessorImpl::resizePhotoRegion(const cv::Mat &source, cv::Mat &destination) {
+        if (photoNeedsResize) {
+            // Area averaging, every full resolution pixel of the region contributes to the result
+            cv::resize(source, destination, destination.size(), 0, 0, cv::INTER_AREA);
         } else {
-            LOG_DEBUG("NativeRubikProcessor", "Frame already at square, no cropping needed.");
+            source.copyTo(destination);
         }
+    }
 
-        // Resize
-        if (needsResize) {
-            LOG_DEBUG("NativeRubikProcessor", "Resizing frame to processing size. Image dimension: %d. Processing dimension: %d.",
-                      frameDimension, DEFAULT_DIMENSION);
-            cv::resize(matImage, matImage, cv::Size(DEFAULT_DIMENSION, DEFAULT_DIMENSION));
-        } else {
-            LOG_DEBUG("NativeRubikProcessor", "Frame already at processing size, no resize needed.");
+    void RubikProcessorImpl::extractFaces(cv::Mat &matImage, cv::Mat &topFace, cv::Mat &leftFace, cv::Mat &rightFace) {
+        // The homographies are cached, only the warps are left for each frame
+        cv::Size faceSize(faceDimension, faceDimension);
+        {
+            ScopedStageTimer timer(ProcessingStage::TOP_FACE_WARP);
+            cv::warpPerspective(matImage, topFace, faceHomographies[0], faceSize);
+        }
+        {
+            ScopedStageTimer timer(ProcessingStage::LEFT_FACE_WARP);
+            cv::warpPerspective(matImage, leftFace, faceHomographies[1], faceSize);
+        }
+        {
+            ScopedStageTimer timer(ProcessingStage::RIGHT_FACE_WARP);
+            cv::warpPerspective(matImage, rightFace, faceHomographies[2], faceSize);
         }
-
-        // Rotate
-        rotateMat(matImage, rotation);
     }
 
-    void RubikProcessorImpl::extractFaces(cv::Mat &matImage, cv::Mat &topFace, cv::Mat &leftFace, cv::Mat &rightFace) {
-        auto lensOffset = static_cast<float>(DEFAULT_DIMENSION * 0.112);
+    void RubikProcessorImpl::computeFaceCorners(std::vector<cv::Point2f> &topFaceCorners,
+                                                std::vector<cv::Point2f> &leftFaceCorners,
+                                                std::vector<cv::Point2f> &rightFaceCorners) const {
+        auto lensOffset = static_cast<float>(processingDimension * 0.112);
         // Top face: top, right, left, bottom
-        std::vector<cv::Point2f> topFaceCorners;
         topFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.5),
-                static_cast<float>(DEFAULT_DIMENSION * 0.0151 + lensOffset))
+                static_cast<float>(processingDimension * 0.5),
+                static_cast<float>(processingDimension * 0.0151 + lensOffset))
         );
         topFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.9899),
-                static_cast<float>(DEFAULT_DIMENSION * 0.2979 ))
+                static_cast<float>(processingDimension * 0.9899),
+                static_cast<float>(processingDimension * 0.2979 ))
         );
         topFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.0101),
-                static_cast<float>(DEFAULT_DIMENSION * 0.2979 ))
+                static_cast<float>(processingDimension * 0.0101),
+                static_cast<float>(processingDimension * 0.2979 ))
         );
         topFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.5),
-                static_cast<float>(DEFAULT_DIMENSION * 0.5808))
+                static_cast<float>(processingDimension * 0.5),
+                static_cast<float>(processingDimension * 0.5808))
         );
-        applyPerspectiveTransform(matImage, topFace, topFaceCorners, cv::Size(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION));
 
         // Left face: top, right, left, bottom
-        std::vector<cv::Point2f> leftFaceCorners;
         leftFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.0801),
-                static_cast<float>(DEFAULT_DIMENSION * 0.1768))
+                static_cast<float>(processingDimension * 0.0801),
+                static_cast<float>(processingDimension * 0.1768))
         );
         leftFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.57),
-                static_cast<float>(DEFAULT_DIMENSION * 0.4596))
+                static_cast<float>(processingDimension * 0.57),
+                static_cast<float>(processingDimension * 0.4596))
         );
         // Apply lens offset scaled to each vector
         leftFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.0801 + lensOffset * cos(30 * CV_PI / 180)),
-                static_cast<float>(DEFAULT_DIMENSION * 0.7425 - lensOffset * sin(30 * CV_PI / 180)))
+                static_cast<float>(processingDimension * 0.0801 + lensOffset * cos(30 * CV_PI / 180)),
+                static_cast<float>(processingDimension * 0.7425 - lensOffset * sin(30 * CV_PI / 180)))
         );
         leftFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.57),
-                static_cast<float>(DEFAULT_DIMENSION * 1.0253))
+                static_cast<float>(processingDimension * 0.57),
+                static_cast<float>(processingDimension * 1.0253))
         );
-        applyPerspectiveTransform(matImage, leftFace, leftFaceCorners, cv::Size(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION));
 
         // Right face: top, right, left, bottom
-        std::vector<cv::Point2f> rightFaceCorners;
         rightFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.43),
-                static_cast<float>(DEFAULT_DIMENSION * 0.4596))
+                static_cast<float>(processingDimension * 0.43),
+                static_cast<float>(processingDimension * 0.4596))
         );
         rightFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.9199),
-                static_cast<float>(DEFAULT_DIMENSION * 0.1768 ))
+                static_cast<float>(processingDimension * 0.9199),
+                static_cast<float>(processingDimension * 0.1768 ))
         );
         rightFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.43),
-                static_cast<float>(DEFAULT_DIMENSION * 1.0253))
+                static_cast<float>(processingDimension * 0.43),
+                static_cast<float>(processingDimension * 1.0253))
         );
         // Apply lens offset scaled to each vector
         rightFaceCorners.emplace_back(cv::Point2f(
-                static_cast<float>(DEFAULT_DIMENSION * 0.9199 - lensOffset * cos(30 * CV_PI / 180)),
-                static_cast<float>(DEFAULT_DIMENSION * 0.7425 - lensOffset * sin(30 * CV_PI / 180)))
+                static_cast<float>(processingDimension * 0.9199 - lensOffset * cos(30 * CV_PI / 180)),
+                static_cast<float>(processingDimension * 0.7425 - lensOffset * sin(30 * CV_PI / 180)))
         );
-        applyPerspectiveTransform(matImage, rightFace, rightFaceCorners, cv::Size(DEFAULT_FACE_DIMENSION, DEFAULT_FACE_DIMENSION));
     }
 
-    void RubikProcessorImpl::applyPerspectiveTransform(const cv::Mat &inputImage, cv::Mat &outputImage,
-                                                       const std::vector<cv::Point2f> &inputPoints,
-                                                       const cv::Size &outputSize) {
+    std::vector<cv::Point2f> RubikProcessorImpl::computeOutputCorners(const cv::Size &outputSize) const {
         std::vector<cv::Point2f> outputPoints;
         outputPoints.emplace_back(cv::Point2f(0, 0));
         outputPoints.emplace_back(cv::Point2f(outputSize.width - 1, 0));
         outputPoints.emplace_back(cv::Point2f(0, outputSize.height - 1));
         outputPoints.emplace_back(cv::Point2f(outputSize.width - 1, outputSize.height - 1));
+        return outputPoints;
+    }
 
-        //Apply the perspective transformation
-        auto perspectiveMatrix = cv::getPerspectiveTransform(inputPoints, outputPoints);
-        cv::warpPerspective(inputImage, outputImage, perspectiveMatrix, outputSize);
+    void RubikProcessorImpl::recordFrame(const FrameRole role, const int frameNr, const uint8_t *frameData) {
+        std::lock_guard<std::mutex> lock(recordingMutex);
+        if (recordingWriter.isOpen()) {
+            recordingWriter.append(role, frameNr, frameData);
+        }
     }
 
-    void RubikProcessorImpl::saveFacelets(std::vector<std::vector<RubikFacelet>> &topFacelets, cv::Mat &topFaceHSV,
-                                          std::vector<std::vector<RubikFacelet>> &leftFacelets, cv::Mat &leftFaceHSV,
-                                          std::vector<std::vector<RubikFacelet>> &rightFacelets, cv::Mat &rightFaceHSV,
+    void RubikProcessorImpl::saveFacelets(const FaceGrid &topGrid, cv::Mat &topFaceHSV,
+                                          const FaceGrid &leftGrid, cv::Mat &leftFaceHSV,
+                                          const FaceGrid &rightGrid, cv::Mat &rightFaceHSV,
                                           const uint8_t *data) {
         int savedFacelets = 0;
         int phaseOffset = 0;
@@ -417,7 +844,7 @@ namespace rbdt {
         // Top
         for (int i = 0; i < 3; i++) {
             for (int j = 0; j < 3; j++) {
-                RubikFacelet facelet = topFacelets[i][j];
+                const RubikFacelet &facelet = topGrid.at(i, j);
                 float innerCircleRadius = facelet.innerCircleRadius() / 3;
                 cv::Rect roi = cv::Rect(
                         cv::Point2f(facelet.center.x - innerCircleRadius, facelet.center.y - innerCircleRadius),
@@ -425,7 +852,7 @@ namespace rbdt {
                 );
                 cv::Mat stickerHSV(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION, CV_8UC3,
                                    (uchar *) data + firstFaceletOffset + phaseOffset + (savedFacelets * faceletByteCount));
-                LOG_DEBUG("TESTING", "Original size: %d x %d, resized to: %d x %d",
+                LOG_VERBOSE("TESTING", "Original size: %d x %d, resized to: %d x %d",
                           roi.width, roi.height, DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION);
                 cv::resize(topFaceHSV(roi), stickerHSV, cv::Size(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION),
                            cv::InterpolationFlags::INTER_CUBIC);
@@ -435,7 +862,7 @@ namespace rbdt {
         // Left
         for (int i = 0; i < 3; i++) {
             for (int j = 0; j < 3; j++) {
-                RubikFacelet facelet = leftFacelets[i][j];
+                const RubikFacelet &facelet = leftGrid.at(i, j);
                 float innerCircleRadius = facelet.innerCircleRadius() / 3;
                 cv::Rect roi = cv::Rect(
                         cv::Point2f(facelet.center.x - innerCircleRadius, facelet.center.y - innerCircleRadius),
@@ -443,7 +870,7 @@ namespace rbdt {
                 );
                 cv::Mat stickerHSV(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION, CV_8UC3,
                                    (uchar *) data + firstFaceletOffset + phaseOffset + (savedFacelets * faceletByteCount));
-                LOG_DEBUG("TESTING", "Original size: %d x %d, resized to: %d x %d",
+                LOG_VERBOSE("TESTING", "Original size: %d x %d, resized to: %d x %d",
                           roi.width, roi.height, DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION);
                 cv::resize(leftFaceHSV(roi), stickerHSV, cv::Size(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION),
                            cv::InterpolationFlags::INTER_CUBIC);
@@ -453,7 +880,7 @@ namespace rbdt {
         // Right
         for (int i = 0; i < 3; i++) {
             for (int j = 0; j < 3; j++) {
-                RubikFacelet facelet = rightFacelets[i][j];
+                const RubikFacelet &facelet = rightGrid.at(i, j);
                 float innerCircleRadius = facelet.innerCircleRadius() / 3;
                 cv::Rect roi = cv::Rect(
                         cv::Point2f(facelet.center.x - innerCircleRadius, facelet.center.y - innerCircleRadius),
@@ -461,7 +888,7 @@ namespace rbdt {
                 );
                 cv::Mat stickerHSV(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION, CV_8UC3,
                                    (uchar *) data + firstFaceletOffset + phaseOffset + (savedFacelets * faceletByteCount));
-                LOG_DEBUG("TESTING", "Original size: %d x %d, resized to: %d x %d",
+                LOG_VERBOSE("TESTING", "Original size: %d x %d, resized to: %d x %d",
                           roi.width, roi.height, DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION);
                 cv::resize(rightFaceHSV(roi), stickerHSV, cv::Size(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION),
                            cv::InterpolationFlags::INTER_CUBIC);
@@ -494,13 +921,21 @@ namespace rbdt {
         return i[5] < j[5];
     }
 
+    void RubikProcessorImpl::computeFaceletColors(const uint8_t *data) {
+        const int pixelCount = DEFAULT_FACELET_DIMENSION * DEFAULT_FACELET_DIMENSION;
+        for (int i = 0; i < CubeState::FACELET_COUNT; i++) {
+            faceletColors[i] = labLookupTable.mean(data + firstFaceletOffset + (i * faceletByteCount), pixelCount);
+        }
+    }
+
     CubeState RubikProcessorImpl::analyzeColorsInternal(const uint8_t *data) {
-        int processedFacelets = 0;
-        for (int i = 0; i < 54; i++) {
-            cv::Mat facelet(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION, CV_8UC3,
-                            (uchar *) data + firstFaceletOffset + (processedFacelets * faceletByteCount));
-            imageSaver->saveImage(facelet, i + 1, "");
-            processedFacelets++;
+        ScopedStageTimer timer(ProcessingStage::COLOR_ANALYSIS);
+        if (isSavingImages(imageSaver)) {
+            for (int i = 0; i < 54; i++) {
+                cv::Mat facelet(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION, CV_8UC3,
+                                (uchar *) data + firstFaceletOffset + (i * faceletByteCount));
+                imageSaver->saveImage(facelet, i + 1, "");
+            }
         }
         /// Finished saving for debug
 
@@ -559,7 +994,7 @@ namespace rbdt {
                     int closestFaceletIndex = std::distance(ciede2000ToFaceCenters.begin(), minDistance);
                     ciede2000ToFaceCenters[closestFaceletIndex] = distancePlaceholder;
                     faceletsFaces[closestFaceletIndex] = 0;
-                    LOG_DEBUG("TESTING", "Facelet %d at face %d identified as 0", (closestFaceletIndex % 9) + 1,
+                    LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as 0", (closestFaceletIndex % 9) + 1,
                               (closestFaceletIndex / 9) + 1);
                     break;
                 }
@@ -568,7 +1003,7 @@ namespace rbdt {
                     int closestFaceletIndex = std::distance(ciede2000ToFaceCenters.begin(), minDistance);
                     ciede2000ToFaceCenters[closestFaceletIndex] = distancePlaceholder;
                     faceletsFaces[closestFaceletIndex] = 1;
-                    LOG_DEBUG("TESTING", "Facelet %d at face %d identified as 1", (closestFaceletIndex % 9) + 1,
+                    LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as 1", (closestFaceletIndex % 9) + 1,
                               (closestFaceletIndex / 9) + 1);
                     break;
                 }
@@ -577,7 +1012,7 @@ namespace rbdt {
                     int closestFaceletIndex = std::distance(ciede2000ToFaceCenters.begin(), minDistance);
                     ciede2000ToFaceCenters[closestFaceletIndex] = distancePlaceholder;
                     faceletsFaces[closestFaceletIndex] = 2;
-                    LOG_DEBUG("TESTING", "Facelet %d at face %d identified as 2", (closestFaceletIndex % 9) + 1,
+                    LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as 2", (closestFaceletIndex % 9) + 1,
                               (closestFaceletIndex / 9) + 1);
                     break;
                 }
@@ -586,7 +1021,7 @@ namespace rbdt {
                     int closestFaceletIndex = std::distance(ciede2000ToFaceCenters.begin(), minDistance);
                     ciede2000ToFaceCenters[closestFaceletIndex] = distancePlaceholder;
                     faceletsFaces[closestFaceletIndex] = 3;
-                    LOG_DEBUG("TESTING", "Facelet %d at face %d identified as 3", (closestFaceletIndex % 9) + 1,
+                    LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as 3", (closestFaceletIndex % 9) + 1,
                               (closestFaceletIndex / 9) + 1);
                     break;
                 }
@@ -595,7 +1030,7 @@ namespace rbdt {
                     int closestFaceletIndex = std::distance(ciede2000ToFaceCenters.begin(), minDistance);
                     ciede2000ToFaceCenters[closestFaceletIndex] = distancePlaceholder;
                     faceletsFaces[closestFaceletIndex] = 4;
-                    LOG_DEBUG("TESTING", "Facelet %d at face %d identified as 4", (closestFaceletIndex % 9) + 1,
+                    LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as 4", (closestFaceletIndex % 9) + 1,
                               (closestFaceletIndex / 9) + 1);
                     break;
                 }
@@ -604,7 +1039,7 @@ namespace rbdt {
                     int closestFaceletIndex = std::distance(ciede2000ToFaceCenters.begin(), minDistance);
                     ciede2000ToFaceCenters[closestFaceletIndex] = distancePlaceholder;
                     faceletsFaces[closestFaceletIndex] = 5;
-                    LOG_DEBUG("TESTING", "Facelet %d at face %d identified as 5", (closestFaceletIndex % 9) + 1,
+                    LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as 5", (closestFaceletIndex % 9) + 1,
                               (closestFaceletIndex / 9) + 1);
                     break;
                 }
@@ -622,7 +1057,7 @@ namespace rbdt {
                                  3, 5, 1, 1, 5, 0, 3, 4, 5};
         for (int i = 0; i < 54; i++) {
             if (faceletsFaces[i] != correctColors[i]) {
-                LOG_DEBUG("TESTING", "Facelet %d at face %d identified as %d when it was %d",
+                LOG_VERBOSE("TESTING", "Facelet %d at face %d identified as %d when it was %d",
                           (i % 9) + 1, (i / 9) + 1, faceletsFaces[i], correctColors[i]);
             }
         }
@@ -658,81 +1093,23 @@ namespace rbdt {
     */
 
         /**/
-        std::vector<cv::Scalar_<float>> meanValues(0);
-        for (int i = 0; i < 54; i++) {
-            cv::Mat facelet(DEFAULT_FACELET_DIMENSION, DEFAULT_FACELET_DIMENSION, CV_8UC3,
-                            (uchar *) data + firstFaceletOffset + (i * faceletByteCount));
+        computeFaceletColors(data);
 
-            cv::Mat faceletLab;
-            cv::cvtColor(facelet, faceletLab, cv::COLOR_BGR2Lab);
-            std::vector<cv::Mat> labChannels(3);
-            cv::split(faceletLab, labChannels);
-            meanValues.emplace_back(cv::Scalar_<float>(
-                    static_cast<float>(cv::mean(labChannels[0])[0]),
-                    static_cast<float>(cv::mean(labChannels[1])[0]),
-                    static_cast<float>(cv::mean(labChannels[2])[0])));
-        }
-
-        std::vector<int> labels;
-        std::vector<cv::Scalar> kMeansCenters;
-        int expectedDifferentColors = 6;
-
-        cv::TermCriteria criteria(CV_TERMCRIT_ITER, 10, 0.5);
-        cv::kmeans(meanValues, expectedDifferentColors, labels, criteria, 10, cv::KmeansFlags::KMEANS_PP_CENTERS, kMeansCenters);
-
-        // UP, FRONT, RIGHT, DOWN, LEFT, BACK
-        std::vector<int> faceCentersLabels;
-        faceCentersLabels.emplace_back(labels[4]);
-        faceCentersLabels.emplace_back(labels[13]);
-        faceCentersLabels.emplace_back(labels[22]);
-        faceCentersLabels.emplace_back(labels[31]);
-        faceCentersLabels.emplace_back(labels[40]);
-        faceCentersLabels.emplace_back(labels[49]);
-
-        for (int i = 0; i < 6; i++) {
-            for (int j = i + 1; j < 6; j++) {
-                if (faceCentersLabels[i] == faceCentersLabels[j]) {
-                    // If different centers have the same label the cube is invalid or the colors have been misidentified
-                    return CubeState();
-                }
-            }
-        }
+        // Exactly 9 facelets per face, anchored on the centers. Always gives a complete assignment
+        std::array<CubeState::Face, CubeState::FACELET_COUNT> facelets;
+        std::array<cv::Scalar, CubeState::FACE_COUNT> colors;
+        colorAssignment.solve(faceletColors, facelets, colors);
 
         for (int i = 0; i < 54; i++) {
-            LOG_DEBUG("TESTING",
-                      "Facelet %d with mean LAB (%.2f, %.2f, %.2f) has been labeled as part of group %d which has center on (%.2f, %.2f, %.2f)",
+            LOG_VERBOSE("TESTING",
+                      "Facelet %d with mean LAB (%.2f, %.2f, %.2f) has been assigned to face %d which has color (%.2f, %.2f, %.2f)",
                       i + 1,
-                      meanValues[i][0], meanValues[i][1], meanValues[i][2],
-                      labels[i],
-                      kMeansCenters[labels[i]][0], kMeansCenters[labels[i]][1], kMeansCenters[labels[i]][2]);
-        }
-
-
-        std::vector<CubeState::Face> facelets(0);
-        for (int i = 0; i < 54; i++) {
-            if (labels[i] == faceCentersLabels[0]) {
-                facelets.emplace_back(CubeState::Face::UP);
-            } else if (labels[i] == faceCentersLabels[1]) {
-                facelets.emplace_back(CubeState::Face::FRONT);
-            } else if (labels[i] == faceCentersLabels[2]) {
-                facelets.emplace_back(CubeState::Face::RIGHT);
-            } else if (labels[i] == faceCentersLabels[3]) {
-                facelets.emplace_back(CubeState::Face::DOWN);
-            } else if (labels[i] == faceCentersLabels[4]) {
-                facelets.emplace_back(CubeState::Face::LEFT);
-            } else if (labels[i] == faceCentersLabels[5]) {
-                facelets.emplace_back(CubeState::Face::BACK);
-            }
+                      faceletColors[i][0], faceletColors[i][1], faceletColors[i][2],
+                      static_cast<int>(facelets[i]),
+                      colors[static_cast<int>(facelets[i])][0], colors[static_cast<int>(facelets[i])][1],
+                      colors[static_cast<int>(facelets[i])][2]);
         }
 
-        std::vector<cv::Scalar> colors(0);
-        colors.emplace_back(kMeansCenters[faceCentersLabels[0]]);
-        colors.emplace_back(kMeansCenters[faceCentersLabels[1]]);
-        colors.emplace_back(kMeansCenters[faceCentersLabels[2]]);
-        colors.emplace_back(kMeansCenters[faceCentersLabels[3]]);
-        colors.emplace_back(kMeansCenters[faceCentersLabels[4]]);
-        colors.emplace_back(kMeansCenters[faceCentersLabels[5]]);
-
         return CubeState(facelets, colors);
         /**/
     }
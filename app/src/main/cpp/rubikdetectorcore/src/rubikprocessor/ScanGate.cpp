@@ -0,0 +1,55 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include "../../include/rubikdetector/rubikprocessor/internal/ScanGate.hpp"
+
+namespace rbdt {
+
+    void ScanGate::configure(int frameWidth, int frameHeight, const cv::Rect &region) {
+        this->frameWidth = frameWidth;
+        this->frameHeight = frameHeight;
+        this->region = region.area() > 0 ? region : cv::Rect(0, 0, frameWidth, frameHeight);
+        hasReference = false;
+        consecutiveSkips = 0;
+    }
+
+    bool ScanGate::shouldProcess(const uint8_t *frameY, ScanOutcome &skipReason) {
+        cv::Mat frame(frameHeight, frameWidth, CV_8UC1, (uchar *) frameY);
+        cv::resize(frame(region), current, cv::Size(GATE_DIMENSION, GATE_DIMENSION), 0, 0, cv::INTER_AREA);
+        if (consecutiveSkips >= MAX_CONSECUTIVE_SKIPS) {
+            consecutiveSkips = 0;
+            return true;
+        }
+
+        cv::Laplacian(current, laplacian, CV_16S);
+        cv::Scalar mean;
+        cv::Scalar standardDeviation;
+        cv::meanStdDev(laplacian, mean, standardDeviation);
+        if (standardDeviation[0] * standardDeviation[0] < MIN_SHARPNESS) {
+            skipReason = ScanOutcome::SKIPPED_BLURRY;
+            consecutiveSkips++;
+            return false;
+        }
+
+        if (hasReference && cv::norm(current, reference, cv::NORM_L1) / current.total() < MIN_MOTION) {
+            skipReason = ScanOutcome::SKIPPED_UNCHANGED;
+            consecutiveSkips++;
+            return false;
+        }
+        consecutiveSkips = 0;
+        return true;
+    }
+
+    void ScanGate::onProcessed(bool cubeFound) {
+        if (cubeFound) {
+            hasReference = false;
+        } else {
+            // The next frames are compared to this one. Both buffers keep the gate size, so copying doesn't reallocate
+            current.copyTo(reference);
+            hasReference = true;
+        }
+    }
+
+} //namespace rbdt
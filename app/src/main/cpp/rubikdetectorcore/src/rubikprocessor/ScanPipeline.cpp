@@ -0,0 +1,112 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include "../../include/rubikdetector/rubikprocessor/internal/ScanPipeline.hpp"
+#include "../../include/rubikdetector/rubikprocessor/OnCubeDetectionResultListener.hpp"
+#include "../../include/rubikdetector/utils/CrossLog.hpp"
+
+namespace rbdt {
+
+    ScanPipeline::ScanPipeline(int depth, int facesByteCount, PreprocessingStage preprocessingStage,
+                               DetectionStage detectionStage) :
+            facesByteCount(facesByteCount),
+            preprocessingStage(std::move(preprocessingStage)),
+            detectionStage(std::move(detectionStage)),
+            slotsMemory(static_cast<size_t>(depth) * facesByteCount),
+            submittedJobs(1),
+            preprocessedJobs(depth),
+            freeSlots(depth) {
+        for (int i = 0; i < depth; i++) {
+            freeSlots.push(i);
+        }
+        preprocessingThread = std::thread(&ScanPipeline::preprocessingLoop, this);
+        detectionThread = std::thread(&ScanPipeline::detectionLoop, this);
+    }
+
+    ScanPipeline::~ScanPipeline() {
+        // Closing the queues in stage order lets every accepted frame reach the listener before the threads exit
+        submittedJobs.close();
+        preprocessingThread.join();
+        preprocessedJobs.close();
+        detectionThread.join();
+        LOG_DEBUG("NativeRubikProcessor", "ScanPipeline - destructor.");
+    }
+
+    void ScanPipeline::setListener(std::shared_ptr<OnCubeDetectionResultListener> listener) {
+        std::lock_guard<std::mutex> lock(listenerMutex);
+        this->listener = listener;
+    }
+
+    bool ScanPipeline::submit(const uint8_t *scanData, int frameNumber) {
+        {
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            inFlightJobs++;
+        }
+        if (!submittedJobs.tryPush(ScanJob{scanData, frameNumber, -1, false})) {
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            inFlightJobs--;
+            LOG_DEBUG("NativeRubikProcessor", "ScanPipeline - pipeline full, dropping frame %d.", frameNumber);
+            return false;
+        }
+        return true;
+    }
+
+    void ScanPipeline::flush() {
+        std::unique_lock<std::mutex> lock(inFlightMutex);
+        allDone.wait(lock, [this]() { return inFlightJobs == 0; });
+    }
+
+    void ScanPipeline::preprocessingLoop() {
+        ScanJob job;
+        while (submittedJobs.pop(job)) {
+            freeSlots.pop(job.slot);
+            try {
+                preprocessingStage(job.scanData, slotsMemory.data() + job.slot * facesByteCount);
+                job.preprocessed = true;
+            } catch (...) {
+                LOG_ERROR("NativeRubikProcessor", "ScanPipeline - preprocessing failed for frame %d.", job.frameNumber);
+                job.preprocessed = false;
+            }
+            // Failed jobs go through the detection stage too, which keeps the results in submission order
+            preprocessedJobs.push(job);
+        }
+    }
+
+    void ScanPipeline::detectionLoop() {
+        ScanJob job;
+        while (preprocessedJobs.pop(job)) {
+            bool cubeFound = false;
+            try {
+                if (job.preprocessed) {
+                    cubeFound = detectionStage(slotsMemory.data() + job.slot * facesByteCount, job.frameNumber);
+                }
+            } catch (...) {
+                LOG_ERROR("NativeRubikProcessor", "ScanPipeline - detection failed for frame %d.", job.frameNumber);
+            }
+            onJobDone(job, cubeFound);
+        }
+    }
+
+    void ScanPipeline::onJobDone(const ScanJob &job, bool cubeFound) {
+        freeSlots.push(job.slot);
+        std::shared_ptr<OnCubeDetectionResultListener> currentListener;
+        {
+            std::lock_guard<std::mutex> lock(listenerMutex);
+            currentListener = listener;
+        }
+        if (currentListener != nullptr) {
+            try {
+                currentListener->onCubeDetectionResult(job.scanData, job.frameNumber, cubeFound);
+            } catch (...) {
+                LOG_ERROR("NativeRubikProcessor", "ScanPipeline - listener failed for frame %d.", job.frameNumber);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            inFlightJobs--;
+        }
+        allDone.notify_all();
+    }
+
+} //namespace rbdt
@@ -16,6 +16,7 @@ namespace rbdt {
             mPhotoRotation(DEFAULT_PHOTO_ROTATION),
             mPhotoWidth(DEFAULT_PHOTO_WIDTH),
             mPhotoHeight(DEFAULT_PHOTO_HEIGHT),
+            mResolutionProfile(ResolutionProfile::DEFAULT),
             mFaceletsDetector(nullptr),
             mColorDetector(nullptr),
             mImageSaver(nullptr) {}
@@ -42,6 +43,11 @@ namespace rbdt {
         return *this;
     }
 
+    RubikProcessorBuilder &RubikProcessorBuilder::resolutionProfile(ResolutionProfile profile) {
+        mResolutionProfile = profile;
+        return *this;
+    }
+
     RubikProcessorBuilder &RubikProcessorBuilder::colorDetector(
             std::unique_ptr<RubikColorDetector> colorDetector) {
         mColorDetector = std::move(colorDetector);
@@ -76,6 +82,7 @@ namespace rbdt {
         RubikProcessor *rubikDetector = new RubikProcessor(
                 ImageProperties(mScanRotation, mScanWidth, mScanHeight),
                 ImageProperties(mPhotoRotation, mPhotoWidth, mPhotoHeight),
+                mResolutionProfile,
                 std::move(mFaceletsDetector),
                 std::move(mColorDetector),
                 mImageSaver);
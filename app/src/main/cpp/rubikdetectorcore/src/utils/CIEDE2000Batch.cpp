@@ -0,0 +1,329 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core/hal/intrin.hpp>
+#include "../../include/rubikdetector/utils/CIEDE2000Batch.hpp"
+
+namespace rbdt {
+
+namespace {
+
+const float PI = 3.14159265358979f;
+
+const float HALF_PI = PI / 2.0f;
+
+const float TWO_PI = PI * 2.0f;
+
+const float DEGREE = PI / 180.0f;
+
+/**
+ * pow(25, 7)
+ */
+const float POW_25_TO_7 = 6103515625.0f;
+
+/**
+ * sin & cos of the angle offsets of Equation 15.
+ */
+const float COS_30 = 0.866025404f;
+
+const float SIN_30 = 0.5f;
+
+const float COS_6 = 0.994521895f;
+
+const float SIN_6 = 0.104528463f;
+
+const float COS_63 = 0.453990500f;
+
+const float SIN_63 = 0.891006524f;
+
+/**
+ * Upper bound of the exponent of Equation 16. exp(-20) is about 2e-9, so the rotation term is already negligible there.
+ */
+const float MAX_THETA_EXPONENT = 20.0f;
+
+/**
+ * The exponential of Equation 16 is computed as pow(exp(-z / 32), 32), which keeps the argument of the polynomial small.
+ */
+const float THETA_EXPONENT_SCALE = 1.0f / 32.0f;
+
+/**
+ * Operations on one color at a time.
+ */
+struct ScalarLanes {
+    typedef float Value;
+
+    static float all(float value) {
+        return value;
+    }
+
+    static float select(bool mask, float ifTrue, float ifFalse) {
+        return mask ? ifTrue : ifFalse;
+    }
+
+    static float sqrt(float value) {
+        return std::sqrt(value);
+    }
+
+    static float abs(float value) {
+        return std::abs(value);
+    }
+
+    static float min(float first, float second) {
+        return std::min(first, second);
+    }
+
+    static float max(float first, float second) {
+        return std::max(first, second);
+    }
+};
+
+#if CV_SIMD128
+
+/**
+ * Operations on 4 colors at a time.
+ */
+struct VectorLanes {
+    typedef cv::v_float32x4 Value;
+
+    static cv::v_float32x4 all(float value) {
+        return cv::v_setall_f32(value);
+    }
+
+    static cv::v_float32x4 select(const cv::v_float32x4 &mask, const cv::v_float32x4 &ifTrue, const cv::v_float32x4 &ifFalse) {
+        return cv::v_select(mask, ifTrue, ifFalse);
+    }
+
+    static cv::v_float32x4 sqrt(const cv::v_float32x4 &value) {
+        return cv::v_sqrt(value);
+    }
+
+    static cv::v_float32x4 abs(const cv::v_float32x4 &value) {
+        return cv::v_abs(value);
+    }
+
+    static cv::v_float32x4 min(const cv::v_float32x4 &first, const cv::v_float32x4 &second) {
+        return cv::v_min(first, second);
+    }
+
+    static cv::v_float32x4 max(const cv::v_float32x4 &first, const cv::v_float32x4 &second) {
+        return cv::v_max(first, second);
+    }
+};
+
+#endif
+
+template<typename Lanes>
+typename Lanes::Value pow7(const typename Lanes::Value &x) {
+    typename Lanes::Value x2 = x * x;
+    return x2 * x2 * x2 * x;
+}
+
+/**
+ * Taylor polynomial of sin, for x in [-pi / 2, pi / 2]. The error is below 6e-8 there.
+ */
+template<typename Lanes>
+typename Lanes::Value sine(const typename Lanes::Value &x) {
+    typename Lanes::Value x2 = x * x;
+    typename Lanes::Value result = Lanes::all(-1.0f / 39916800.0f);
+    result = result * x2 + Lanes::all(1.0f / 362880.0f);
+    result = result * x2 + Lanes::all(-1.0f / 5040.0f);
+    result = result * x2 + Lanes::all(1.0f / 120.0f);
+    result = result * x2 + Lanes::all(-1.0f / 6.0f);
+    result = result * x2 + Lanes::all(1.0f);
+    return result * x;
+}
+
+/**
+ * Taylor polynomial of cos, for x in [-pi / 2, pi / 2]. The error is below 1e-8 there.
+ */
+template<typename Lanes>
+typename Lanes::Value cosine(const typename Lanes::Value &x) {
+    typename Lanes::Value x2 = x * x;
+    typename Lanes::Value result = Lanes::all(1.0f / 479001600.0f);
+    result = result * x2 + Lanes::all(-1.0f / 3628800.0f);
+    result = result * x2 + Lanes::all(1.0f / 40320.0f);
+    result = result * x2 + Lanes::all(-1.0f / 720.0f);
+    result = result * x2 + Lanes::all(1.0f / 24.0f);
+    result = result * x2 + Lanes::all(-1.0f / 2.0f);
+    return result * x2 + Lanes::all(1.0f);
+}
+
+/**
+ * sin & cos of an angle in [0, 2 * pi). The angle is moved to [-pi / 2, pi / 2], where the polynomials above are accurate.
+ */
+template<typename Lanes>
+void sineCosine(const typename Lanes::Value &angle, typename Lanes::Value &sin, typename Lanes::Value &cos) {
+    typedef typename Lanes::Value V;
+    const V zero = Lanes::all(0.0f);
+    const V pi = Lanes::all(PI);
+    const V halfPi = Lanes::all(HALF_PI);
+    // sin(angle) = -sin(centered) & cos(angle) = -cos(centered), with centered in [-pi, pi)
+    V centered = angle - pi;
+    V folded = Lanes::select(centered > halfPi, pi - centered,
+                             Lanes::select(centered < zero - halfPi, zero - pi - centered, centered));
+    V foldedCos = cosine<Lanes>(folded);
+    sin = zero - sine<Lanes>(folded);
+    cos = Lanes::select(Lanes::abs(centered) > halfPi, foldedCos, zero - foldedCos);
+}
+
+/**
+ * Polynomial of atan from Abramowitz & Stegun 4.4.49, for x in [0, 1]. The error is below 2e-8 there.
+ */
+template<typename Lanes>
+typename Lanes::Value arctangent(const typename Lanes::Value &x) {
+    typename Lanes::Value x2 = x * x;
+    typename Lanes::Value result = Lanes::all(-0.0040540580f);
+    result = result * x2 + Lanes::all(0.0218612288f);
+    result = result * x2 + Lanes::all(-0.0559098861f);
+    result = result * x2 + Lanes::all(0.0964200441f);
+    result = result * x2 + Lanes::all(-0.1390853351f);
+    result = result * x2 + Lanes::all(0.1994653599f);
+    result = result * x2 + Lanes::all(-0.3332985605f);
+    result = result * x2 + Lanes::all(0.9999993329f);
+    return result * x;
+}
+
+/**
+ * atan2(b, a) moved to [0, 2 * pi), with 0 when both are 0. This is the hue angle of Equation 7.
+ */
+template<typename Lanes>
+typename Lanes::Value hueAngle(const typename Lanes::Value &b, const typename Lanes::Value &a) {
+    typedef typename Lanes::Value V;
+    const V zero = Lanes::all(0.0f);
+    V absA = Lanes::abs(a);
+    V absB = Lanes::abs(b);
+    V largest = Lanes::max(absA, absB);
+    V ratio = Lanes::min(absA, absB) / Lanes::select(largest == zero, Lanes::all(1.0f), largest);
+    V angle = arctangent<Lanes>(ratio);
+    angle = Lanes::select(absB > absA, Lanes::all(HALF_PI) - angle, angle);
+    angle = Lanes::select(a < zero, Lanes::all(PI) - angle, angle);
+    return Lanes::select(b < zero, Lanes::all(TWO_PI) - angle, angle);
+}
+
+/**
+ * exp(-z), for z in [0, MAX_THETA_EXPONENT]. The Taylor polynomial is evaluated on z / 32, and the result raised to the power 32.
+ */
+template<typename Lanes>
+typename Lanes::Value negativeExp(const typename Lanes::Value &z) {
+    typename Lanes::Value x = z * Lanes::all(-THETA_EXPONENT_SCALE);
+    typename Lanes::Value result = Lanes::all(1.0f / 5040.0f);
+    result = result * x + Lanes::all(1.0f / 720.0f);
+    result = result * x + Lanes::all(1.0f / 120.0f);
+    result = result * x + Lanes::all(1.0f / 24.0f);
+    result = result * x + Lanes::all(1.0f / 6.0f);
+    result = result * x + Lanes::all(1.0f / 2.0f);
+    result = result * x + Lanes::all(1.0f);
+    result = result * x + Lanes::all(1.0f);
+    for (int i = 0; i < 5; i++) {
+        result = result * result;
+    }
+    return result;
+}
+
+/**
+ * CIEDE2000::CIEDE2000() with k_L = k_C = k_H = 1, in float. The equation numbers are the ones of the reference.
+ */
+template<typename Lanes>
+typename Lanes::Value ciede2000(const typename Lanes::Value &l1, const typename Lanes::Value &a1, const typename Lanes::Value &b1,
+                                const typename Lanes::Value &l2, const typename Lanes::Value &a2, const typename Lanes::Value &b2) {
+    typedef typename Lanes::Value V;
+    const V zero = Lanes::all(0.0f);
+    const V half = Lanes::all(0.5f);
+    const V one = Lanes::all(1.0f);
+    const V two = Lanes::all(2.0f);
+    const V pi = Lanes::all(PI);
+    const V twoPi = Lanes::all(TWO_PI);
+    const V pow25To7 = Lanes::all(POW_25_TO_7);
+
+    /* Equations 2 - 4 */
+    V barC = (Lanes::sqrt(a1 * a1 + b1 * b1) + Lanes::sqrt(a2 * a2 + b2 * b2)) * half;
+    V barC7 = pow7<Lanes>(barC);
+    V G = half * (one - Lanes::sqrt(barC7 / (barC7 + pow25To7)));
+    /* Equations 5 - 7 */
+    V a1Prime = (one + G) * a1;
+    V a2Prime = (one + G) * a2;
+    V CPrime1 = Lanes::sqrt(a1Prime * a1Prime + b1 * b1);
+    V CPrime2 = Lanes::sqrt(a2Prime * a2Prime + b2 * b2);
+    V hPrime1 = hueAngle<Lanes>(b1, a1Prime);
+    V hPrime2 = hueAngle<Lanes>(b2, a2Prime);
+
+    /* Equations 8 - 11 */
+    V deltaLPrime = l2 - l1;
+    V deltaCPrime = CPrime2 - CPrime1;
+    V CPrimeProduct = CPrime1 * CPrime2;
+    V hPrimeDifference = hPrime2 - hPrime1;
+    hPrimeDifference = Lanes::select(hPrimeDifference < zero - pi, hPrimeDifference + twoPi,
+                                     Lanes::select(hPrimeDifference > pi, hPrimeDifference - twoPi, hPrimeDifference));
+    V deltahPrime = Lanes::select(CPrimeProduct == zero, zero, hPrimeDifference);
+    V deltaHPrime = two * Lanes::sqrt(CPrimeProduct) * sine<Lanes>(deltahPrime * half);
+
+    /* Equations 12 - 14 */
+    V barLPrime = (l1 + l2) * half;
+    V barCPrime = (CPrime1 + CPrime2) * half;
+    V hPrimeSum = hPrime1 + hPrime2;
+    V wrappedMean = Lanes::select(hPrimeSum < twoPi, hPrimeSum + twoPi, hPrimeSum - twoPi) * half;
+    V barhPrime = Lanes::select(CPrimeProduct == zero, hPrimeSum,
+                                Lanes::select(Lanes::abs(hPrime1 - hPrime2) <= pi, hPrimeSum * half, wrappedMean));
+
+    /* Equation 15, the multiples of barhPrime come from its sin & cos */
+    V sin1, cos1;
+    sineCosine<Lanes>(barhPrime, sin1, cos1);
+    V cos2 = two * cos1 * cos1 - one;
+    V sin2 = two * sin1 * cos1;
+    V cos3 = cos2 * cos1 - sin2 * sin1;
+    V sin3 = sin2 * cos1 + cos2 * sin1;
+    V cos4 = two * cos2 * cos2 - one;
+    V sin4 = two * sin2 * cos2;
+    V T = one - Lanes::all(0.17f) * (cos1 * Lanes::all(COS_30) + sin1 * Lanes::all(SIN_30)) +
+          Lanes::all(0.24f) * cos2 +
+          Lanes::all(0.32f) * (cos3 * Lanes::all(COS_6) - sin3 * Lanes::all(SIN_6)) -
+          Lanes::all(0.20f) * (cos4 * Lanes::all(COS_63) + sin4 * Lanes::all(SIN_63));
+    /* Equation 16 */
+    V thetaOffset = (barhPrime - Lanes::all(275.0f * DEGREE)) * Lanes::all(1.0f / (25.0f * DEGREE));
+    V deltaTheta = Lanes::all(30.0f * DEGREE) *
+                   negativeExp<Lanes>(Lanes::min(thetaOffset * thetaOffset, Lanes::all(MAX_THETA_EXPONENT)));
+    /* Equations 17 - 21 */
+    V barCPrime7 = pow7<Lanes>(barCPrime);
+    V R_C = two * Lanes::sqrt(barCPrime7 / (barCPrime7 + pow25To7));
+    V lOffset = barLPrime - Lanes::all(50.0f);
+    V lOffset2 = lOffset * lOffset;
+    V S_L = one + Lanes::all(0.015f) * lOffset2 / Lanes::sqrt(Lanes::all(20.0f) + lOffset2);
+    V S_C = one + Lanes::all(0.045f) * barCPrime;
+    V S_H = one + Lanes::all(0.015f) * barCPrime * T;
+    // 2 * deltaTheta is in [0, pi / 3]
+    V R_T = (zero - sine<Lanes>(two * deltaTheta)) * R_C;
+
+    /* Equation 22 */
+    V lightness = deltaLPrime / S_L;
+    V chroma = deltaCPrime / S_C;
+    V hue = deltaHPrime / S_H;
+    return Lanes::sqrt(Lanes::max(zero, lightness * lightness + chroma * chroma + hue * hue + R_T * chroma * hue));
+}
+
+} //namespace
+
+void computeCIEDE2000Matrix(const LabColors &first, const LabColors &second, float *distances) {
+    for (int row = 0; row < first.count; row++) {
+        float *rowDistances = distances + row * second.count;
+        int column = 0;
+#if CV_SIMD128
+        const cv::v_float32x4 l1 = cv::v_setall_f32(first.l[row]);
+        const cv::v_float32x4 a1 = cv::v_setall_f32(first.a[row]);
+        const cv::v_float32x4 b1 = cv::v_setall_f32(first.b[row]);
+        for (; column + 4 <= second.count; column += 4) {
+            cv::v_store(rowDistances + column,
+                        ciede2000<VectorLanes>(l1, a1, b1, cv::v_load(second.l + column), cv::v_load(second.a + column),
+                                               cv::v_load(second.b + column)));
+        }
+#endif
+        for (; column < second.count; column++) {
+            rowDistances[column] = ciede2000<ScalarLanes>(first.l[row], first.a[row], first.b[row],
+                                                          second.l[column], second.a[column], second.b[column]);
+        }
+    }
+}
+
+} //namespace rbdt
@@ -0,0 +1,81 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include "../../include/rubikdetector/utils/LatencyRecorder.hpp"
+
+namespace rbdt {
+
+    LatencyRecorder &LatencyRecorder::instance() {
+        static LatencyRecorder recorder;
+        return recorder;
+    }
+
+    LatencyRecorder::LatencyRecorder() {
+        for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+            bucketUpperBounds[bucket] = static_cast<int64_t>(std::ceil(8.0 * std::pow(2.0, bucket / 4.0)));
+        }
+        reset();
+    }
+
+    void LatencyRecorder::record(ProcessingStage stage, int64_t micros) {
+        int stageIndex = static_cast<int>(stage);
+        if (stageIndex < 0 || stageIndex >= STAGE_COUNT) {
+            return;
+        }
+        histograms[stageIndex][bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<StageLatency> LatencyRecorder::snapshot() const {
+        std::vector<StageLatency> result;
+        result.reserve(STAGE_COUNT);
+        uint32_t bucketCounts[BUCKET_COUNT];
+        for (int stageIndex = 0; stageIndex < STAGE_COUNT; stageIndex++) {
+            uint32_t count = 0;
+            for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+                bucketCounts[bucket] = histograms[stageIndex][bucket].load(std::memory_order_relaxed);
+                count += bucketCounts[bucket];
+            }
+            StageLatency latency;
+            latency.stage = static_cast<ProcessingStage>(stageIndex);
+            latency.count = count;
+            latency.p50Millis = percentileMillis(bucketCounts, count, 0.50f);
+            latency.p95Millis = percentileMillis(bucketCounts, count, 0.95f);
+            latency.p99Millis = percentileMillis(bucketCounts, count, 0.99f);
+            result.push_back(latency);
+        }
+        return result;
+    }
+
+    void LatencyRecorder::reset() {
+        for (int stageIndex = 0; stageIndex < STAGE_COUNT; stageIndex++) {
+            for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+                histograms[stageIndex][bucket].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    int LatencyRecorder::bucketOf(int64_t micros) const {
+        const int64_t *bound = std::lower_bound(bucketUpperBounds, bucketUpperBounds + BUCKET_COUNT, micros);
+        return std::min(static_cast<int>(bound - bucketUpperBounds), BUCKET_COUNT - 1);
+    }
+
+    float LatencyRecorder::percentileMillis(const uint32_t *bucketCounts, uint32_t count, float percentile) const {
+        if (count == 0) {
+            return 0;
+        }
+        // Rank of the sample at the given percentile, 1 based
+        uint32_t rank = static_cast<uint32_t>(std::ceil(percentile * count));
+        uint32_t accumulated = 0;
+        for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+            accumulated += bucketCounts[bucket];
+            if (accumulated >= rank) {
+                return bucketUpperBounds[bucket] / 1000.0f;
+            }
+        }
+        return bucketUpperBounds[BUCKET_COUNT - 1] / 1000.0f;
+    }
+
+} //end namespace rbdt
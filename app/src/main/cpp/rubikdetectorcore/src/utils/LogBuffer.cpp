@@ -0,0 +1,81 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <cstdarg>
+#include <algorithm>
+#include <cstdio>
+#include "../../include/rubikdetector/utils/LogBuffer.hpp"
+
+#ifdef __ANDROID__
+
+#include <android/log.h>
+
+#endif
+
+namespace rbdt {
+
+    LogBuffer &LogBuffer::instance() {
+        static LogBuffer buffer;
+        return buffer;
+    }
+
+    LogBuffer::LogBuffer() : nextIndex(0) {
+        for (int i = 0; i < CAPACITY; i++) {
+            entries[i].sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void LogBuffer::append(int level, const char *tag, const char *format, ...) {
+        const uint64_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        Entry &entry = entries[index % CAPACITY];
+
+        entry.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        entry.level = level;
+        entry.tag = tag;
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(entry.message, MESSAGE_LENGTH, format, arguments);
+        va_end(arguments);
+
+        entry.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    void LogBuffer::flush() {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        const uint64_t endIndex = nextIndex.load(std::memory_order_acquire);
+        uint64_t index = nextFlushIndex;
+        if (endIndex - index > static_cast<uint64_t>(CAPACITY)) {
+            // The oldest messages were already overwritten
+            index = endIndex - CAPACITY;
+        }
+
+        char message[MESSAGE_LENGTH];
+        for (; index < endIndex; index++) {
+            const Entry &entry = entries[index % CAPACITY];
+            const uint64_t expectedSequence = 2 * index + 2;
+            if (entry.sequence.load(std::memory_order_acquire) != expectedSequence) {
+                continue;
+            }
+            const int level = entry.level;
+            const char *tag = entry.tag;
+            std::copy(entry.message, entry.message + MESSAGE_LENGTH, message);
+            message[MESSAGE_LENGTH - 1] = '\0';
+            // A writer which wrapped around while copying makes the sequence change, the copy is discarded in that case
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) != expectedSequence) {
+                continue;
+            }
+#ifdef __ANDROID__
+            __android_log_write(level, tag, message);
+#else
+            (void) level;
+            printf("\n%s: %s", tag, message);
+#endif
+        }
+        nextFlushIndex = endIndex;
+    }
+
+} //end namespace rbdt
@@ -114,7 +114,7 @@ void drawCircles(cv::Mat &drawingCanvas, const std::vector<std::vector<Circle>>
 /* return current time in milliseconds */
 double getCurrentTimeMillis() {
     struct timespec res;
-    clock_gettime(CLOCK_REALTIME, &res);
+    clock_gettime(CLOCK_MONOTONIC, &res);
     return 1000.0 * res.tv_sec + (double) res.tv_nsec / 1e6;
 }
 
@@ -0,0 +1,84 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include "../../include/rubikdetector/utils/WorkerPool.hpp"
+#include "../../include/rubikdetector/utils/CrossLog.hpp"
+
+namespace rbdt {
+
+    TaskLatch::TaskLatch(int count) : pending(count) {}
+
+    void TaskLatch::countDown() {
+        // Notified under the lock, so the waiter can't return & destroy the latch before this call is done with it
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            condition.notify_all();
+        }
+    }
+
+    void TaskLatch::wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return pending == 0; });
+    }
+
+    WorkerPool::WorkerPool(int threadCount) {
+        postedTasks.reserve(POSTED_TASK_CAPACITY);
+        int workerCount = threadCount < 1 ? 1 : threadCount;
+        workers.reserve(workerCount);
+        for (int i = 0; i < workerCount; i++) {
+            workers.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCondition.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        LOG_DEBUG("NativeRubikProcessor", "WorkerPool - destructor.");
+    }
+
+    void WorkerPool::post(PooledTask &task) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            postedTasks.push_back(&task);
+        }
+        queueCondition.notify_one();
+    }
+
+    int WorkerPool::size() const {
+        return static_cast<int>(workers.size());
+    }
+
+    void WorkerPool::workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            PooledTask *postedTask = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this]() { return stopping || !tasks.empty() || !postedTasks.empty(); });
+                if (!postedTasks.empty()) {
+                    postedTask = postedTasks.front();
+                    postedTasks.erase(postedTasks.begin());
+                } else if (!tasks.empty()) {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                } else {
+                    // only reachable when stopping, after the queues have been drained
+                    return;
+                }
+            }
+            if (postedTask != nullptr) {
+                postedTask->run();
+            } else {
+                task();
+            }
+        }
+    }
+
+} //end namespace rbdt
@@ -0,0 +1,158 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../rubikdetectorcore/include/rubikdetector/utils/CIEDE2000.h"
+#include "../../rubikdetectorcore/include/rubikdetector/utils/CIEDE2000Batch.hpp"
+
+/**
+ * Compares rbdt::computeCIEDE2000Matrix() with the CIEDE2000::CIEDE2000() reference, for accuracy & for throughput.
+ *
+ * Usage:
+ * <pre>
+ * rubikdetector_ciede2000_benchmark [--colors N] [--iterations N] [--seed N]
+ * </pre>
+ *
+ * The distance matrix between N random colors, plus the achromatic & axis aligned colors the reference handles separately, is
+ * computed by both. The largest difference is reported, and the tool fails when it exceeds rbdt::CIEDE2000_BATCH_MAX_ERROR.
+ * Pairs whose hues are almost exactly 180 degrees apart are left out of that check, see rbdt::CIEDE2000_BATCH_MAX_ERROR.
+ */
+namespace {
+
+    /**
+     * Hue differences closer than this to 180 degrees are not checked, in radians.
+     */
+    const double OPPOSITE_HUES_MARGIN = 1e-4;
+
+    void printUsage() {
+        std::printf("usage: rubikdetector_ciede2000_benchmark [--colors N] [--iterations N] [--seed N]\n");
+    }
+
+    struct Colors {
+        std::vector<float> l;
+
+        std::vector<float> a;
+
+        std::vector<float> b;
+
+        void add(float lValue, float aValue, float bValue) {
+            l.push_back(lValue);
+            a.push_back(aValue);
+            b.push_back(bValue);
+        }
+
+        int count() const {
+            return (int) l.size();
+        }
+
+        rbdt::LabColors view() const {
+            return rbdt::LabColors{l.data(), a.data(), b.data(), count()};
+        }
+
+        CIEDE2000::LAB at(int i) const {
+            return CIEDE2000::LAB{l[i], a[i], b[i]};
+        }
+    };
+
+    bool areHuesOpposite(const CIEDE2000::LAB &first, const CIEDE2000::LAB &second) {
+        if ((first.a == 0 && first.b == 0) || (second.a == 0 && second.b == 0)) {
+            return false;
+        }
+        double difference = std::abs(std::atan2(first.b, first.a) - std::atan2(second.b, second.a));
+        return std::abs(difference - M_PI) < OPPOSITE_HUES_MARGIN;
+    }
+
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} //end anonymous namespace
+
+int main(int argc, char **argv) {
+    int colorCount = 1000;
+    int iterations = 5;
+    unsigned int seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--colors" && i + 1 < argc) {
+            colorCount = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--seed" && i + 1 < argc) {
+            seed = (unsigned int) std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    Colors colors;
+    // Achromatic & axis aligned colors, which take the special cases of Equations 7, 10 & 14
+    const float axisValues[] = {-100.0f, -0.0f, 0.0f, 100.0f};
+    for (float aValue : axisValues) {
+        for (float bValue : axisValues) {
+            colors.add(50.0f, aValue, bValue);
+        }
+    }
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> lightness(0.0f, 100.0f);
+    std::uniform_real_distribution<float> opponent(-128.0f, 127.0f);
+    for (int i = 0; i < colorCount; i++) {
+        colors.add(lightness(generator), opponent(generator), opponent(generator));
+    }
+    const int count = colors.count();
+    const double pairCount = (double) count * count;
+
+    std::vector<float> distances((size_t) count * count);
+    double batchMillis = 0;
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        auto start = std::chrono::steady_clock::now();
+        rbdt::computeCIEDE2000Matrix(colors.view(), colors.view(), distances.data());
+        batchMillis += millisSince(start);
+    }
+
+    std::vector<double> referenceDistances((size_t) count * count);
+    auto start = std::chrono::steady_clock::now();
+    for (int row = 0; row < count; row++) {
+        for (int column = 0; column < count; column++) {
+            referenceDistances[(size_t) row * count + column] = CIEDE2000::CIEDE2000(colors.at(row), colors.at(column));
+        }
+    }
+    double referenceMillis = millisSince(start);
+
+    double maxError = 0;
+    double errorSum = 0;
+    int skipped = 0;
+    for (int row = 0; row < count; row++) {
+        for (int column = 0; column < count; column++) {
+            if (areHuesOpposite(colors.at(row), colors.at(column))) {
+                skipped++;
+                continue;
+            }
+            size_t index = (size_t) row * count + column;
+            double error = std::abs(distances[index] - referenceDistances[index]);
+            maxError = std::max(maxError, error);
+            errorSum += error;
+        }
+    }
+
+    std::printf("%-12s pairs %10.0f  %10.3f ms  %8.2f Mpairs/s\n", "reference", pairCount, referenceMillis,
+                pairCount / referenceMillis / 1000.0);
+    std::printf("%-12s pairs %10.0f  %10.3f ms  %8.2f Mpairs/s\n", "batch", pairCount, batchMillis / iterations,
+                pairCount * iterations / batchMillis / 1000.0);
+    std::printf("error: max %.6f  mean %.8f  bound %.6f  (%d pairs with opposite hues skipped)\n", maxError,
+                errorSum / (pairCount - skipped), (double) rbdt::CIEDE2000_BATCH_MAX_ERROR, skipped);
+    if (maxError > rbdt::CIEDE2000_BATCH_MAX_ERROR) {
+        std::fprintf(stderr, "the batch distances exceed the error bound\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <opencv2/imgproc/imgproc.hpp>
+#include "../../rubikdetectorcore/include/rubikdetector/rubikprocessor/internal/LabLookupTable.hpp"
+#include "../../rubikdetectorcore/include/rubikdetector/utils/CIEDE2000.h"
+
+/**
+ * Compares rbdt::LabLookupTable::convert() with OpenCV's float cv::COLOR_BGR2Lab, for accuracy & for throughput.
+ *
+ * Usage:
+ * <pre>
+ * rubikdetector_lab_lookup_table_benchmark [--step N] [--iterations N]
+ * </pre>
+ *
+ * Every channel takes the levels 0, N, 2N... & 255, so the 8 bit BGR cube is sampled with a stride of N, 1 for the whole cube.
+ * Each sampled color is converted by both, and the CIEDE2000 distance between the two results is measured. The largest distance is
+ * reported, and the tool fails when it exceeds rbdt::LAB_LOOKUP_TABLE_MAX_ERROR.
+ */
+namespace {
+
+    void printUsage() {
+        std::printf("usage: rubikdetector_lab_lookup_table_benchmark [--step N] [--iterations N]\n");
+    }
+
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} //end anonymous namespace
+
+int main(int argc, char **argv) {
+    int step = 1;
+    int iterations = 5;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--step" && i + 1 < argc) {
+            step = std::min(255, std::max(1, std::atoi(argv[++i])));
+        } else if (argument == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<uint8_t> levels;
+    for (int level = 0; level < 255; level += step) {
+        levels.push_back((uint8_t) level);
+    }
+    levels.push_back(255);
+    const int levelCount = (int) levels.size();
+    const int colorCount = levelCount * levelCount * levelCount;
+
+    cv::Mat bgr(colorCount, 1, CV_8UC3);
+    int color = 0;
+    for (uint8_t blue : levels) {
+        for (uint8_t green : levels) {
+            for (uint8_t red : levels) {
+                bgr.at<cv::Vec3b>(color++) = cv::Vec3b(blue, green, red);
+            }
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    rbdt::LabLookupTable table;
+    double buildMillis = millisSince(start);
+
+    std::vector<cv::Vec3f> tableLab((size_t) colorCount);
+    double tableMillis = 0;
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < colorCount; i++) {
+            const cv::Vec3b &pixel = bgr.at<cv::Vec3b>(i);
+            tableLab[i] = table.convert(pixel[0], pixel[1], pixel[2]);
+        }
+        tableMillis += millisSince(start);
+    }
+
+    // Same conversion the table nodes go through, float input in [0, 1]
+    cv::Mat bgrFloat;
+    cv::Mat referenceLab;
+    start = std::chrono::steady_clock::now();
+    bgr.convertTo(bgrFloat, CV_32FC3, 1.0 / 255.0);
+    cv::cvtColor(bgrFloat, referenceLab, cv::COLOR_BGR2Lab);
+    double referenceMillis = millisSince(start);
+
+    double maxError = 0;
+    double errorSum = 0;
+    int worst = 0;
+    for (int i = 0; i < colorCount; i++) {
+        const cv::Vec3f &reference = referenceLab.at<cv::Vec3f>(i);
+        const cv::Vec3f &approximation = tableLab[i];
+        double error = CIEDE2000::CIEDE2000(CIEDE2000::LAB{reference[0], reference[1], reference[2]},
+                                            CIEDE2000::LAB{approximation[0], approximation[1], approximation[2]});
+        errorSum += error;
+        if (error > maxError) {
+            maxError = error;
+            worst = i;
+        }
+    }
+
+    std::printf("table built in %.3f ms\n", buildMillis);
+    std::printf("%-12s colors %10d  %10.3f ms  %8.2f Mcolors/s\n", "cvtColor", colorCount, referenceMillis,
+                colorCount / referenceMillis / 1000.0);
+    std::printf("%-12s colors %10d  %10.3f ms  %8.2f Mcolors/s\n", "table", colorCount, tableMillis / iterations,
+                (double) colorCount * iterations / tableMillis / 1000.0);
+    const cv::Vec3b &worstColor = bgr.at<cv::Vec3b>(worst);
+    std::printf("error: max %.6f at BGR (%d, %d, %d)  mean %.6f  bound %.6f\n", maxError, worstColor[0], worstColor[1],
+                worstColor[2], errorSum / colorCount, (double) rbdt::LAB_LOOKUP_TABLE_MAX_ERROR);
+    if (maxError > rbdt::LAB_LOOKUP_TABLE_MAX_ERROR) {
+        std::fprintf(stderr, "the table colors exceed the error bound\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
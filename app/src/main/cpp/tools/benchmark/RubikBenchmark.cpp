@@ -0,0 +1,275 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "../../rubikdetectorcore/include/rubikdetector/detectors/faceletsdetector/SimpleFaceletsDetector.hpp"
+#include "../../rubikdetectorcore/include/rubikdetector/rubikprocessor/builder/RubikProcessorBuilder.hpp"
+#include "../../rubikdetectorcore/include/rubikdetector/rubikprocessor/RubikProcessor.hpp"
+#include "../common/FrameCorpus.hpp"
+
+/**
+ * Times RubikProcessor::processScan(), RubikProcessor::processPhoto() & RubikProcessor::processColors() over recorded NV21 frames.
+ *
+ * Usage:
+ * <pre>
+ * rubikdetector_benchmark --scan 640x480@90 <scan frames dir> [--photo 4032x3024@90 <photo frames dir>] [--iterations N] [--profile P] [--no-tracking] [--no-cascade] [--no-gate] [--fail-on-allocations]
+ * rubikdetector_benchmark --recording <recording file> [--iterations N] [--profile P] [--no-tracking] [--no-cascade] [--no-gate] [--fail-on-allocations]
+ *
+ * --profile selects the ResolutionProfile: fast, default or precise.
+ *
+ * --no-tracking makes the facelets detector run the full detection on every frame, see SimpleFaceletsDetector::setTrackingEnabled().
+ * --no-cascade makes every scan frame detect the three faces, see RubikProcessor::setScanCascadeEnabled().
+ * --no-gate makes every scan frame go through the detection, see RubikProcessor::setScanGateEnabled().
+ * --fail-on-allocations fails the benchmark if the scan frames still allocate once warmed up, instead of only warning.
+ * </pre>
+ *
+ * The heap allocations made during each processScan() call are counted as well, through the global operator new. The first pass over
+ * the scan frames warms the processor up, so it is left out of the count. Once warmed up, the containers of rbdt itself are reused, but
+ * OpenCV still allocates inside the detection (e.g. cv::Canny() & cv::findContours()), so the allocations counted after the first pass
+ * only print a warning, unless --fail-on-allocations is given.
+ */
+namespace {
+
+    std::atomic<long> allocationCount(0);
+
+    struct Timings {
+        std::vector<double> millis;
+
+        int hits = 0;
+    };
+
+    struct Allocations {
+        long total = 0;
+
+        long max = 0;
+
+        int calls = 0;
+    };
+
+    void printUsage() {
+        std::printf("usage: rubikdetector_benchmark --scan WxH@ROT <scan frames dir> [--photo WxH@ROT <photo frames dir>] "
+                    "[--iterations N] [--profile fast|default|precise] [--no-tracking] [--no-cascade] [--no-gate] "
+                    "[--fail-on-allocations]\n"
+                    "       rubikdetector_benchmark --recording <recording file> [--iterations N] [--profile fast|default|precise] "
+                    "[--no-tracking] [--no-cascade] [--no-gate] [--fail-on-allocations]\n");
+    }
+
+    bool parseResolutionProfile(const std::string &name, rbdt::ResolutionProfile &profile) {
+        if (name == "fast") {
+            profile = rbdt::ResolutionProfile::FAST;
+        } else if (name == "default") {
+            profile = rbdt::ResolutionProfile::DEFAULT;
+        } else if (name == "precise") {
+            profile = rbdt::ResolutionProfile::PRECISE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void printTimings(const char *name, Timings &timings) {
+        if (timings.millis.empty()) {
+            return;
+        }
+        double total = 0;
+        for (double sample : timings.millis) {
+            total += sample;
+        }
+        const size_t count = timings.millis.size();
+        std::printf("%-14s calls %6zu  hits %6d  mean %8.3f ms  p50 %8.3f ms  p95 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",
+                    name, count, timings.hits, total / count,
+                    rbdt::tools::percentile(timings.millis, 0.50),
+                    rbdt::tools::percentile(timings.millis, 0.95),
+                    rbdt::tools::percentile(timings.millis, 0.99),
+                    rbdt::tools::percentile(timings.millis, 1.0));
+    }
+
+    void printAllocations(const char *name, const Allocations &allocations) {
+        if (allocations.calls == 0) {
+            std::printf("%-14s allocations not counted, needs --iterations 2 or more\n", name);
+            return;
+        }
+        std::printf("%-14s calls %6d  allocations per call: mean %8.2f  max %6ld\n",
+                    name, allocations.calls, (double) allocations.total / allocations.calls, allocations.max);
+    }
+
+    template<typename CALL>
+    double timeMillis(CALL call, bool &result) {
+        auto start = std::chrono::steady_clock::now();
+        result = call();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+} //end anonymous namespace
+
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+int main(int argc, char **argv) {
+    rbdt::tools::FrameCorpus scanCorpus;
+    rbdt::tools::FrameCorpus photoCorpus;
+    std::string scanDirectory;
+    std::string photoDirectory;
+    std::string recordingPath;
+    int iterations = 1;
+    rbdt::ResolutionProfile profile = rbdt::ResolutionProfile::DEFAULT;
+    bool tracking = true;
+    bool cascade = true;
+    bool gate = true;
+    bool failOnAllocations = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--scan" && i + 2 < argc) {
+            if (!rbdt::tools::parseFrameProperties(argv[++i], scanCorpus.width, scanCorpus.height, scanCorpus.rotation)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+            scanDirectory = argv[++i];
+        } else if (argument == "--photo" && i + 2 < argc) {
+            if (!rbdt::tools::parseFrameProperties(argv[++i], photoCorpus.width, photoCorpus.height, photoCorpus.rotation)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+            photoDirectory = argv[++i];
+        } else if (argument == "--recording" && i + 1 < argc) {
+            recordingPath = argv[++i];
+        } else if (argument == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--profile" && i + 1 < argc) {
+            if (!parseResolutionProfile(argv[++i], profile)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (argument == "--no-tracking") {
+            tracking = false;
+        } else if (argument == "--no-cascade") {
+            cascade = false;
+        } else if (argument == "--no-gate") {
+            gate = false;
+        } else if (argument == "--fail-on-allocations") {
+            failOnAllocations = true;
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (scanDirectory.empty() == recordingPath.empty()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::string error;
+    rbdt::FrameRecordingReader recording;
+    if (!recordingPath.empty()) {
+        if (!recording.open(recordingPath, error) || !rbdt::tools::loadRecordedFrames(recording, scanCorpus, photoCorpus, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+    } else if (!rbdt::tools::loadRawFrames(scanDirectory, scanCorpus, error) ||
+               (!photoDirectory.empty() && !rbdt::tools::loadRawFrames(photoDirectory, photoCorpus, error))) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<rbdt::SimpleFaceletsDetector> faceletsDetector(new rbdt::SimpleFaceletsDetector());
+    faceletsDetector->setTrackingEnabled(tracking);
+    rbdt::RubikProcessorBuilder builder;
+    builder.scanSize(scanCorpus.width, scanCorpus.height).scanRotation(scanCorpus.rotation)
+            .resolutionProfile(profile)
+            .faceletsDetector(std::move(faceletsDetector));
+    if (!photoCorpus.frames.empty()) {
+        builder.photoSize(photoCorpus.width, photoCorpus.height).photoRotation(photoCorpus.rotation);
+    }
+    std::unique_ptr<rbdt::RubikProcessor> processor(builder.build());
+    processor->setScanCascadeEnabled(cascade);
+    processor->setScanGateEnabled(gate);
+
+    // Same buffer layout the app uses: the frame at its offset, followed by the faces & the facelets
+    std::vector<uint8_t> buffer(static_cast<size_t>(processor->getRequiredMemory()));
+    uint8_t *frameData = buffer.data() + processor->getFrameYUVBufferOffset();
+    rbdt::RubikProcessor::resetStageLatencies();
+
+    Timings scanTimings;
+    Timings photoTimings;
+    Timings colorTimings;
+    Allocations scanAllocations;
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        for (const uint8_t *frame : scanCorpus.frames) {
+            std::memcpy(frameData, frame, scanCorpus.frameByteCount());
+            bool found = false;
+            long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            double millis = timeMillis([&]() { return processor->processScan(buffer.data()); }, found);
+            long allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            scanTimings.millis.push_back(millis);
+            scanTimings.hits += found;
+            if (iteration > 0) {
+                scanAllocations.total += allocations;
+                scanAllocations.max = std::max(scanAllocations.max, allocations);
+                scanAllocations.calls++;
+            }
+        }
+
+        // Photos are taken in pairs, one for each half of the cube. The colors get analyzed once both halves were found
+        bool isSecondPhase = false;
+        processor->updateScanPhase(isSecondPhase);
+        for (const uint8_t *photo : photoCorpus.frames) {
+            bool found = false;
+            photoTimings.millis.push_back(timeMillis([&]() { return processor->processPhoto(buffer.data(), photo); }, found));
+            photoTimings.hits += found;
+            if (!found) {
+                continue;
+            }
+            if (!isSecondPhase) {
+                isSecondPhase = true;
+            } else {
+                bool valid = false;
+                colorTimings.millis.push_back(timeMillis([&]() {
+                    return processor->processColors(buffer.data()).valid;
+                }, valid));
+                colorTimings.hits += valid;
+                isSecondPhase = false;
+            }
+            processor->updateScanPhase(isSecondPhase);
+        }
+    }
+
+    printTimings("processScan", scanTimings);
+    printTimings("processPhoto", photoTimings);
+    printTimings("processColors", colorTimings);
+    if (!scanCorpus.frames.empty()) {
+        printAllocations("processScan", scanAllocations);
+    }
+
+    std::printf("\n");
+    rbdt::tools::printStageLatencies(rbdt::RubikProcessor::getStageLatencies());
+    if (scanAllocations.total > 0) {
+        std::fprintf(stderr, "\n%s: %ld heap allocations over %d warmed up scan frames, expected none\n",
+                     failOnAllocations ? "FAILED" : "WARNING", scanAllocations.total, scanAllocations.calls);
+        if (failOnAllocations) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
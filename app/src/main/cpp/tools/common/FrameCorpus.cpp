@@ -0,0 +1,153 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <sys/stat.h>
+#include "FrameCorpus.hpp"
+
+namespace rbdt {
+namespace tools {
+
+    size_t FrameCorpus::frameByteCount() const {
+        return static_cast<size_t>(width) * (height + height / 2);
+    }
+
+    bool parseFrameProperties(const std::string &text, int &width, int &height, int &rotation) {
+        rotation = 0;
+        char separator = 0;
+        int parsed = std::sscanf(text.c_str(), "%dx%d%c%d", &width, &height, &separator, &rotation);
+        if (parsed == 2) {
+            return width > 0 && height > 0;
+        }
+        return parsed == 4 && separator == '@' && width > 0 && height > 0;
+    }
+
+    bool loadRawFrames(const std::string &directory, FrameCorpus &corpus, std::string &error) {
+        DIR *dir = opendir(directory.c_str());
+        if (dir == nullptr) {
+            error = "cannot open directory " + directory;
+            return false;
+        }
+        std::vector<std::string> fileNames;
+        while (dirent *entry = readdir(dir)) {
+            std::string path = directory + "/" + entry->d_name;
+            struct stat fileStat;
+            if (stat(path.c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+                fileNames.push_back(entry->d_name);
+            }
+        }
+        closedir(dir);
+        std::sort(fileNames.begin(), fileNames.end());
+
+        const size_t frameByteCount = corpus.frameByteCount();
+        for (const std::string &fileName : fileNames) {
+            std::ifstream file((directory + "/" + fileName).c_str(), std::ios::binary | std::ios::ate);
+            if (!file || static_cast<size_t>(file.tellg()) != frameByteCount) {
+                error = fileName + " is not a " + std::to_string(corpus.width) + "x" + std::to_string(corpus.height) + " NV21 frame";
+                return false;
+            }
+            file.seekg(0);
+            std::vector<uint8_t> frame(frameByteCount);
+            file.read(reinterpret_cast<char *>(frame.data()), frameByteCount);
+            corpus.names.push_back(fileName);
+            corpus.storage.push_back(std::move(frame));
+        }
+        for (const std::vector<uint8_t> &frame : corpus.storage) {
+            corpus.frames.push_back(frame.data());
+        }
+        if (corpus.frames.empty()) {
+            error = "no frames found in " + directory;
+            return false;
+        }
+        return true;
+    }
+
+    bool loadRecordedFrames(const FrameRecordingReader &reader, FrameCorpus &scanCorpus, FrameCorpus &photoCorpus, std::string &error) {
+        FrameCorpus *corpora[2] = {&scanCorpus, &photoCorpus};
+        const FrameRole roles[2] = {FrameRole::SCAN, FrameRole::PHOTO};
+        for (int i = 0; i < 2; i++) {
+            ImageProperties properties = reader.getImageProperties(roles[i]);
+            corpora[i]->width = properties.width;
+            corpora[i]->height = properties.height;
+            corpora[i]->rotation = properties.rotation;
+        }
+        for (int i = 0; i < reader.getFrameCount(); i++) {
+            FrameRecordingReader::Frame frame = reader.getFrame(i);
+            FrameCorpus &corpus = frame.role == FrameRole::SCAN ? scanCorpus : photoCorpus;
+            if (frame.byteCount != corpus.frameByteCount()) {
+                error = "frame " + std::to_string(frame.frameNumber) + " of the recording has an unexpected size";
+                return false;
+            }
+            corpus.names.push_back("frame_" + std::to_string(frame.frameNumber));
+            corpus.frames.push_back(frame.data);
+        }
+        if (scanCorpus.frames.empty()) {
+            error = "no scan frames found in the recording";
+            return false;
+        }
+        return true;
+    }
+
+    const char *stageName(ProcessingStage stage) {
+        switch (stage) {
+            case ProcessingStage::FRAME:
+                return "frame";
+            case ProcessingStage::SCAN_GATE:
+                return "scan_gate";
+            case ProcessingStage::Y_EXTRACTION:
+                return "y_extraction";
+            case ProcessingStage::CROP_RESIZE_ROTATE:
+                return "crop_resize_rotate";
+            case ProcessingStage::TOP_FACE_WARP:
+                return "top_face_warp";
+            case ProcessingStage::LEFT_FACE_WARP:
+                return "left_face_warp";
+            case ProcessingStage::RIGHT_FACE_WARP:
+                return "right_face_warp";
+            case ProcessingStage::BLUR:
+                return "blur";
+            case ProcessingStage::CANNY:
+                return "canny";
+            case ProcessingStage::FIND_CONTOURS:
+                return "find_contours";
+            case ProcessingStage::FILTER_CONTOURS:
+                return "filter_contours";
+            case ProcessingStage::GRID_MATCHING:
+                return "grid_matching";
+            case ProcessingStage::FACE_TRACKING:
+                return "face_tracking";
+            case ProcessingStage::SAVE_FACELETS:
+                return "save_facelets";
+            case ProcessingStage::COLOR_ANALYSIS:
+                return "color_analysis";
+            default:
+                return "unknown";
+        }
+    }
+
+    void printStageLatencies(const std::vector<StageLatency> &latencies) {
+        std::printf("%-20s %8s %10s %10s %10s\n", "stage", "count", "p50 ms", "p95 ms", "p99 ms");
+        for (const StageLatency &latency : latencies) {
+            if (latency.count > 0) {
+                std::printf("%-20s %8u %10.3f %10.3f %10.3f\n", stageName(latency.stage), latency.count,
+                            latency.p50Millis, latency.p95Millis, latency.p99Millis);
+            }
+        }
+    }
+
+    double percentile(std::vector<double> &samples, double percentile) {
+        if (samples.empty()) {
+            return 0;
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(std::ceil(percentile * samples.size()));
+        return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+} //end namespace tools
+} //end namespace rbdt
@@ -0,0 +1,90 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#ifndef RUBIKDETECTOR_FRAMECORPUS_HPP
+#define RUBIKDETECTOR_FRAMECORPUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../rubikdetectorcore/include/rubikdetector/data/metrics/StageLatency.hpp"
+#include "../../rubikdetectorcore/include/rubikdetector/recording/FrameRecordingReader.hpp"
+
+namespace rbdt {
+namespace tools {
+
+/**
+ * A set of recorded NV21 frames sharing the same size & rotation. The frames are either loaded in memory, or point into a mapped
+ * FrameRecordingReader which needs to outlive the corpus.
+ */
+    struct FrameCorpus {
+        int width = 0;
+
+        int height = 0;
+
+        int rotation = 0;
+
+        std::vector<std::string> names;
+
+        std::vector<const uint8_t *> frames;
+
+        /**
+         * Frames loaded from raw files, pointed to by FrameCorpus::frames.
+         */
+        std::vector<std::vector<uint8_t>> storage;
+
+        /**
+         * @return size in bytes of one frame of the corpus
+         */
+        size_t frameByteCount() const;
+    };
+
+/**
+ * Parses frame properties written as <b>WIDTHxHEIGHT@ROTATION</b>, e.g. 640x480@90. The rotation is optional and defaults to 0.
+ *
+ * @return false if the text is not valid
+ */
+    bool parseFrameProperties(const std::string &text, int &width, int &height, int &rotation);
+
+/**
+ * Loads every regular file of the directory, in name order, as one raw NV21 frame of the corpus size.
+ *
+ * @param [in] directory the directory holding the frames
+ * @param [in,out] corpus with the size & rotation already set. Receives the frames.
+ * @param [out] error description of the problem, if any
+ * @return false if the directory can't be read or a file doesn't have the size of a NV21 frame
+ */
+    bool loadRawFrames(const std::string &directory, FrameCorpus &corpus, std::string &error);
+
+/**
+ * Splits the frames of a recording, in recording order & without copying them, into the scan & the photo corpus. The size & rotation
+ * of both corpora are taken from the recording.
+ *
+ * @param [in] reader an open recording, which needs to outlive both corpora
+ * @param [out] scanCorpus receives the FrameRole::SCAN frames
+ * @param [out] photoCorpus receives the FrameRole::PHOTO frames
+ * @param [out] error description of the problem, if any
+ * @return false if the recording holds no scan frame
+ */
+    bool loadRecordedFrames(const FrameRecordingReader &reader, FrameCorpus &scanCorpus, FrameCorpus &photoCorpus, std::string &error);
+
+/**
+ * @return a short, printable name of the stage
+ */
+    const char *stageName(ProcessingStage stage);
+
+/**
+ * Prints one line per stage which was timed at least once.
+ */
+    void printStageLatencies(const std::vector<StageLatency> &latencies);
+
+/**
+ * Value at the given percentile of the samples, which get sorted in place. 0 if there are no samples.
+ */
+    double percentile(std::vector<double> &samples, double percentile);
+
+} //end namespace tools
+} //end namespace rbdt
+#endif //RUBIKDETECTOR_FRAMECORPUS_HPP
@@ -0,0 +1,255 @@
+//
+// Created by Kohru on 17/10/2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "../../rubikdetectorcore/include/rubikdetector/detectors/colordetector/HistogramColorDetector.hpp"
+#include "../../rubikdetectorcore/include/rubikdetector/rubikprocessor/builder/RubikProcessorBuilder.hpp"
+#include "../../rubikdetectorcore/include/rubikdetector/rubikprocessor/RubikProcessor.hpp"
+#include "../common/FrameCorpus.hpp"
+
+/**
+ * Replays a recorded scanning session through a RubikProcessor, following the same flow as the app: scan frames are processed until
+ * the cube is found, then the next photo is processed. Two successful photos, one per half of the cube, lead to a color analysis.
+ *
+ * A session is a directory with the following content:
+ * <pre>
+ * properties   text file with the frame properties, one per line: "scan 640x480@90" & "photo 4032x3024@90"
+ * scan/        raw NV21 scan frames, replayed in name order
+ * photo/       raw NV21 photos, optional. One is consumed every time a scan frame detects the cube
+ * </pre>
+ *
+ * A session can also be a recording file written through RubikProcessor::startRecording(), in which case the frames are replayed
+ * straight from the mapped file & their properties are taken from the recording.
+ *
+ * Every valid cube state is cross checked with a HistogramColorDetector run on the facelets, which reports how many facelets got the
+ * same histogram color as most of the facelets assigned to their face.
+ *
+ * Usage:
+ * <pre>
+ * rubikdetector_replay <session dir | recording file> [--scan WxH@ROT] [--photo WxH@ROT] [--loops N]
+ * </pre>
+ */
+namespace {
+
+    void printUsage() {
+        std::printf("usage: rubikdetector_replay <session dir | recording file> [--scan WxH@ROT] [--photo WxH@ROT] [--loops N]\n");
+    }
+
+    bool loadSessionProperties(const std::string &sessionDirectory, rbdt::tools::FrameCorpus &scanCorpus,
+                               rbdt::tools::FrameCorpus &photoCorpus, std::string &error) {
+        const std::string path = sessionDirectory + "/properties";
+        std::ifstream file(path.c_str());
+        if (!file) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::string role;
+        std::string properties;
+        while (file >> role >> properties) {
+            rbdt::tools::FrameCorpus *corpus = role == "scan" ? &scanCorpus : role == "photo" ? &photoCorpus : nullptr;
+            if (corpus == nullptr || !rbdt::tools::parseFrameProperties(properties, corpus->width, corpus->height, corpus->rotation)) {
+                error = "invalid line \"" + role + " " + properties + "\" in " + path;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Facelets whose histogram color is the one found most often among the facelets assigned to the same face.
+     */
+    int countHistogramAgreements(const rbdt::CubeState &cubeState, const std::vector<rbdt::ColorDetection> &detections) {
+        const int colorCount = static_cast<int>(rbdt::RubikFacelet::Color::WHITE) + 1;
+        int agreements = 0;
+        for (int face = 0; face < rbdt::CubeState::FACE_COUNT; face++) {
+            int faceColorCounts[colorCount] = {0};
+            for (int i = 0; i < rbdt::CubeState::FACELET_COUNT; i++) {
+                if (static_cast<int>(cubeState.facelets[i]) == face) {
+                    faceColorCounts[static_cast<int>(detections[i].color)]++;
+                }
+            }
+            agreements += *std::max_element(faceColorCounts, faceColorCounts + colorCount);
+        }
+        return agreements;
+    }
+
+    bool isRegularFile(const std::string &path) {
+        struct stat fileStat;
+        return stat(path.c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode);
+    }
+
+    double elapsedMillis(const std::chrono::steady_clock::time_point &start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} //end anonymous namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    const std::string sessionDirectory = argv[1];
+    const bool isRecording = isRegularFile(sessionDirectory);
+    rbdt::tools::FrameCorpus scanCorpus;
+    rbdt::tools::FrameCorpus photoCorpus;
+    std::string error;
+    rbdt::FrameRecordingReader recording;
+    if (isRecording) {
+        if (!recording.open(sessionDirectory, error) || !rbdt::tools::loadRecordedFrames(recording, scanCorpus, photoCorpus, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+    } else if (!loadSessionProperties(sessionDirectory, scanCorpus, photoCorpus, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    int loops = 1;
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        if (isRecording && (argument == "--scan" || argument == "--photo")) {
+            // The properties of a recording can't be overridden, its frames have a fixed size
+            printUsage();
+            return EXIT_FAILURE;
+        } else if (argument == "--scan" && i + 1 < argc) {
+            if (!rbdt::tools::parseFrameProperties(argv[++i], scanCorpus.width, scanCorpus.height, scanCorpus.rotation)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (argument == "--photo" && i + 1 < argc) {
+            if (!rbdt::tools::parseFrameProperties(argv[++i], photoCorpus.width, photoCorpus.height, photoCorpus.rotation)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (argument == "--loops" && i + 1 < argc) {
+            loops = std::max(1, std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (scanCorpus.width == 0) {
+        std::fprintf(stderr, "missing scan frame properties, add them to %s/properties or pass --scan\n", sessionDirectory.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (!isRecording && !rbdt::tools::loadRawFrames(sessionDirectory + "/scan", scanCorpus, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    if (!isRecording && photoCorpus.width != 0 && !rbdt::tools::loadRawFrames(sessionDirectory + "/photo", photoCorpus, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    rbdt::RubikProcessorBuilder builder;
+    builder.scanSize(scanCorpus.width, scanCorpus.height).scanRotation(scanCorpus.rotation);
+    if (photoCorpus.width != 0) {
+        builder.photoSize(photoCorpus.width, photoCorpus.height).photoRotation(photoCorpus.rotation);
+    }
+    std::unique_ptr<rbdt::RubikProcessor> processor(builder.build());
+    std::vector<uint8_t> buffer(static_cast<size_t>(processor->getRequiredMemory()));
+    uint8_t *frameData = buffer.data() + processor->getFrameYUVBufferOffset();
+    rbdt::RubikProcessor::resetStageLatencies();
+
+    int scanFrames = 0;
+    int scanHits = 0;
+    int blurryFrames = 0;
+    int unchangedFrames = 0;
+    int photosProcessed = 0;
+    int photoHits = 0;
+    int colorAnalyses = 0;
+    int validCubeStates = 0;
+    rbdt::HistogramColorDetector histogramDetector;
+    std::vector<rbdt::ColorDetection> histogramDetections;
+    int histogramAgreements = 0;
+    int histogramFacelets = 0;
+    double histogramConfidenceSum = 0;
+    int firstDetectionFrame = -1;
+    double firstDetectionMillis = 0;
+    double scanMillis = 0;
+
+    bool isSecondPhase = false;
+    processor->updateScanPhase(isSecondPhase);
+    size_t nextPhoto = 0;
+    const std::chrono::steady_clock::time_point replayStart = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        for (const uint8_t *frame : scanCorpus.frames) {
+            std::memcpy(frameData, frame, scanCorpus.frameByteCount());
+            const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+            rbdt::ScanOutcome outcome = processor->processScanWithOutcome(buffer.data());
+            scanMillis += elapsedMillis(frameStart);
+            scanFrames++;
+            blurryFrames += outcome == rbdt::ScanOutcome::SKIPPED_BLURRY;
+            unchangedFrames += outcome == rbdt::ScanOutcome::SKIPPED_UNCHANGED;
+            if (outcome != rbdt::ScanOutcome::CUBE_FOUND) {
+                continue;
+            }
+            scanHits++;
+            if (firstDetectionFrame == -1) {
+                firstDetectionFrame = scanFrames;
+                firstDetectionMillis = elapsedMillis(replayStart);
+            }
+            if (nextPhoto >= photoCorpus.frames.size()) {
+                continue;
+            }
+
+            // Like the app, a detection in the scan stream triggers a photo of the same half of the cube
+            photosProcessed++;
+            if (!processor->processPhoto(buffer.data(), photoCorpus.frames[nextPhoto++])) {
+                continue;
+            }
+            photoHits++;
+            if (!isSecondPhase) {
+                isSecondPhase = true;
+            } else {
+                colorAnalyses++;
+                rbdt::CubeState cubeState = processor->processColors(buffer.data());
+                if (cubeState.valid) {
+                    validCubeStates++;
+                    histogramDetector.detectColors(processor->getFaceletPatches(buffer.data()), 0.5f, histogramDetections);
+                    histogramAgreements += countHistogramAgreements(cubeState, histogramDetections);
+                    histogramFacelets += rbdt::CubeState::FACELET_COUNT;
+                    for (const rbdt::ColorDetection &detection : histogramDetections) {
+                        histogramConfidenceSum += detection.confidence;
+                    }
+                }
+                isSecondPhase = false;
+            }
+            processor->updateScanPhase(isSecondPhase);
+        }
+    }
+    const double replayMillis = elapsedMillis(replayStart);
+
+    std::printf("scan frames          %d\n", scanFrames);
+    std::printf("scan throughput      %.2f frames/s\n", scanMillis > 0 ? scanFrames * 1000.0 / scanMillis : 0.0);
+    std::printf("scan detection rate  %.2f%% (%d hits)\n", scanFrames > 0 ? 100.0 * scanHits / scanFrames : 0.0, scanHits);
+    std::printf("skipped frames       %d blurry, %d unchanged\n", blurryFrames, unchangedFrames);
+    if (firstDetectionFrame != -1) {
+        std::printf("first detection      frame %d, after %.2f ms\n", firstDetectionFrame, firstDetectionMillis);
+    } else {
+        std::printf("first detection      none\n");
+    }
+    if (!photoCorpus.frames.empty()) {
+        std::printf("photos               %d processed, %d hits\n", photosProcessed, photoHits);
+        std::printf("color analyses       %d, %d valid cube states\n", colorAnalyses, validCubeStates);
+        if (histogramFacelets > 0) {
+            std::printf("histogram agreement  %.2f%% of the facelets, mean confidence %.2f\n",
+                        100.0 * histogramAgreements / histogramFacelets, histogramConfidenceSum / histogramFacelets);
+        }
+    }
+    std::printf("total replay time    %.2f ms\n\n", replayMillis);
+    rbdt::tools::printStageLatencies(rbdt::RubikProcessor::getStageLatencies());
+    return EXIT_SUCCESS;
+}
@@ -21,6 +21,8 @@ public class RubikDetector {
 
     private static final int DATA_SIZE = 6;
 
+    public static final int STAGE_LATENCY_FIELDS = 4;
+
     private long nativeProcessorRef = NATIVE_DETECTOR_RELEASED;
 
     private int scanWidth;
@@ -131,6 +133,26 @@ public class RubikDetector {
         return nativeProcessorRef != NATIVE_DETECTOR_RELEASED;
     }
 
+    /**
+     * Latency statistics of the native processing stages, process wide: every detector records into them, released ones included.
+     * For each stage, in the order of the native rbdt::ProcessingStage enum, the array holds {@link #STAGE_LATENCY_FIELDS} values:
+     * sample count, p50, p95 and p99 in milliseconds.
+     */
+    @NonNull
+    public static float[] getStageLatencies() {
+        return nativeGetStageLatencies();
+    }
+
+    /**
+     * Writes the log messages retained by the native code to logcat. Release builds of the native code buffer their messages
+     * instead of writing them as they come, call this e.g. when the scan ends or fails.
+     */
+    public void flushLogs() {
+        if (isActive()) {
+            nativeFlushLogs(nativeProcessorRef);
+        }
+    }
+
 
     public int getRequiredMemory() {
         return requiredMemory;
@@ -298,6 +320,10 @@ public class RubikDetector {
 
     private native int nativeGetInputImageOffset(long nativeProcessorRef);
 
+    private static native float[] nativeGetStageLatencies();
+
+    private native void nativeFlushLogs(long nativeProcessorRef);
+
     /*
      * #############################################################################################
      * #############################################################################################